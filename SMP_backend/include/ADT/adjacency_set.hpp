@@ -0,0 +1,499 @@
+#pragma once
+
+#include "hash_map.hpp"
+#include "memory_usage.hpp"
+#include "packed_ids.hpp"
+#include "roaring_set.hpp"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <variant>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ADJACENCY_AVX2 1
+#endif
+
+using NodeID = unsigned long long;
+
+#if defined(HASHMAP_SSE2)
+// Lane-wise 64-bit equality from SSE2's 32-bit compare: both halves must match
+inline __m128i cmpeqIDs(__m128i a, __m128i b)
+{
+    __m128i c = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+#endif
+
+// Intersection of two ascending, duplicate-free ID arrays. Matches are
+// written to out in ascending order (out may be nullptr to only count);
+// returns how many there are.
+//
+// Compares a block of a against a block of b all-pairs in SIMD registers
+// (4x4 with AVX2, 2x2 with SSE2), then drops whichever block has the smaller
+// maximum. Very lopsided inputs gallop (binary search) through the big side.
+inline size_t intersectSortedIDs(const NodeID *a, size_t na, const NodeID *b, size_t nb, NodeID *out)
+{
+    if (na > nb)
+    {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+
+    size_t i = 0, j = 0, k = 0;
+
+    if (na * 32 < nb)
+    {
+        const NodeID *lo = b;
+        const NodeID *end = b + nb;
+        for (; i < na && lo != end; i++)
+        {
+            lo = std::lower_bound(lo, end, a[i]);
+            if (lo != end && *lo == a[i])
+            {
+                if (out)
+                    out[k] = a[i];
+                k++;
+            }
+        }
+        return k;
+    }
+
+#if defined(ADJACENCY_AVX2)
+    while (i + 4 <= na && j + 4 <= nb)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+
+        __m256i eq = _mm256_cmpeq_epi64(va, vb);
+        vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+        vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+        vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+
+        for (unsigned m = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(eq)); m; m &= m - 1)
+        {
+            if (out)
+                out[k] = a[i + CtrlGroup::lowestBit(m)];
+            k++;
+        }
+
+        NodeID aMax = a[i + 3], bMax = b[j + 3];
+        i += aMax <= bMax ? 4 : 0;
+        j += bMax <= aMax ? 4 : 0;
+    }
+#elif defined(HASHMAP_SSE2)
+    while (i + 2 <= na && j + 2 <= nb)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+        __m128i vbSwapped = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i eq = _mm_or_si128(cmpeqIDs(va, vb), cmpeqIDs(va, vbSwapped));
+        for (unsigned m = (unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq)); m; m &= m - 1)
+        {
+            if (out)
+                out[k] = a[i + CtrlGroup::lowestBit(m)];
+            k++;
+        }
+
+        NodeID aMax = a[i + 1], bMax = b[j + 1];
+        i += aMax <= bMax ? 2 : 0;
+        j += bMax <= aMax ? 2 : 0;
+    }
+#endif
+
+    // Scalar merge for the tail (or everything without SIMD)
+    while (i < na && j < nb)
+    {
+        if (a[i] < b[j])
+            i++;
+        else if (b[j] < a[i])
+            j++;
+        else
+        {
+            if (out)
+                out[k] = a[i];
+            k++;
+            i++;
+            j++;
+        }
+    }
+    return k;
+}
+
+// Neighbour set used by Graph. Most users follow a few hundred accounts at
+// most, so a set starts as a plain sorted vector: no table, binary-search
+// lookups, and intersections run as the SIMD merge above. Past PROMOTE_AT
+// members (celebrity follower lists) it moves into a RoaringSet, which
+// stores sequential IDs in a few bits each and intersects word-wise; it
+// drops back to a vector below DEMOTE_AT. A small set that has gone cold can
+// be compress()ed into a PackedIDList; the next change unpacks it. Whatever
+// the form, iteration is ascending.
+class AdjacencySet
+{
+private:
+    static const size_t PROMOTE_AT = 128;
+    static const size_t DEMOTE_AT = 64;
+    static const size_t PACK_MIN = 16; // below this the packed form is no smaller
+
+    std::vector<NodeID> members;          // small sets, ascending
+    std::unique_ptr<RoaringSet> bitmap;   // large sets
+    std::unique_ptr<PackedIDList> packed; // compressed small sets
+
+    void promote()
+    {
+        bitmap.reset(new RoaringSet());
+        for (NodeID id : members)
+            bitmap->insert(id);
+        bitmap->runOptimize();
+        std::vector<NodeID>().swap(members);
+    }
+
+    void demote()
+    {
+        members = bitmap->toVector();
+        bitmap.reset();
+    }
+
+    void unpack()
+    {
+        members = packed->toVector();
+        packed.reset();
+    }
+
+    // Members as one ascending array: the vector itself, or decoded into scratch
+    const std::vector<NodeID> &sortedIDs(std::vector<NodeID> &scratch) const
+    {
+        if (!packed)
+            return members;
+        scratch = packed->toVector();
+        return scratch;
+    }
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = NodeID;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const NodeID *;
+        using reference = NodeID;
+
+    private:
+        // A packed set's decoder carries a block-sized buffer, so it lives on
+        // the heap and only packed iteration pays for it; null once past the end
+        struct PackedCursor
+        {
+            std::unique_ptr<PackedIDList::const_iterator> decoder;
+
+            PackedCursor() = default;
+            explicit PackedCursor(const PackedIDList::const_iterator &i)
+            {
+                if (!i.atEnd())
+                    decoder.reset(new PackedIDList::const_iterator(i));
+            }
+            PackedCursor(const PackedCursor &other)
+                : decoder(other.decoder ? new PackedIDList::const_iterator(*other.decoder) : nullptr) {}
+            PackedCursor &operator=(const PackedCursor &other)
+            {
+                decoder.reset(other.decoder ? new PackedIDList::const_iterator(*other.decoder) : nullptr);
+                return *this;
+            }
+            PackedCursor(PackedCursor &&) noexcept = default;
+            PackedCursor &operator=(PackedCursor &&) noexcept = default;
+        };
+
+        // Small sets, large sets, compressed sets
+        std::variant<const NodeID *, RoaringSet::const_iterator, PackedCursor> pos;
+
+    public:
+        const_iterator() : pos(static_cast<const NodeID *>(nullptr)) {}
+        explicit const_iterator(const NodeID *p) : pos(p) {}
+        explicit const_iterator(RoaringSet::const_iterator i) : pos(i) {}
+        explicit const_iterator(const PackedIDList::const_iterator &i) : pos(PackedCursor(i)) {}
+
+        NodeID operator*() const
+        {
+            if (const NodeID *const *p = std::get_if<0>(&pos))
+                return **p;
+            if (const RoaringSet::const_iterator *it = std::get_if<1>(&pos))
+                return **it;
+            return **std::get_if<2>(&pos)->decoder;
+        }
+
+        const_iterator &operator++()
+        {
+            if (const NodeID **p = std::get_if<0>(&pos))
+            {
+                ++*p;
+            }
+            else if (RoaringSet::const_iterator *it = std::get_if<1>(&pos))
+            {
+                ++*it;
+            }
+            else
+            {
+                std::unique_ptr<PackedIDList::const_iterator> &decoder = std::get_if<2>(&pos)->decoder;
+                if ((++*decoder).atEnd())
+                    decoder.reset();
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            if (const NodeID *const *p = std::get_if<0>(&pos))
+                return *p == *std::get_if<0>(&other.pos);
+            if (const RoaringSet::const_iterator *it = std::get_if<1>(&pos))
+                return *it == *std::get_if<1>(&other.pos);
+
+            // Both at the end, or at the same place in the same list
+            const PackedIDList::const_iterator *a = std::get_if<2>(&pos)->decoder.get();
+            const PackedIDList::const_iterator *b = std::get_if<2>(&other.pos)->decoder.get();
+            return a && b ? *a == *b : a == b;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    AdjacencySet() = default;
+
+    AdjacencySet(const AdjacencySet &other) : members(other.members)
+    {
+        if (other.bitmap)
+            bitmap.reset(new RoaringSet(*other.bitmap));
+        if (other.packed)
+            packed.reset(new PackedIDList(*other.packed));
+    }
+
+    AdjacencySet &operator=(const AdjacencySet &other)
+    {
+        if (this != &other)
+        {
+            members = other.members;
+            bitmap.reset(other.bitmap ? new RoaringSet(*other.bitmap) : nullptr);
+            packed.reset(other.packed ? new PackedIDList(*other.packed) : nullptr);
+        }
+        return *this;
+    }
+
+    AdjacencySet(AdjacencySet &&) noexcept = default;
+    AdjacencySet &operator=(AdjacencySet &&) noexcept = default;
+
+    bool insert(NodeID id)
+    {
+        if (bitmap)
+        {
+            if (!bitmap->insert(id))
+                return false;
+
+            // Re-check for run-encodable ranges each time the set doubles
+            size_t n = bitmap->size();
+            if ((n & (n - 1)) == 0)
+                bitmap->runOptimize();
+            return true;
+        }
+
+        if (packed)
+        {
+            if (packed->contains(id))
+                return false;
+            unpack();
+        }
+
+        auto it = std::lower_bound(members.begin(), members.end(), id);
+        if (it != members.end() && *it == id)
+            return false;
+
+        members.insert(it, id);
+        if (members.size() > PROMOTE_AT)
+            promote();
+        return true;
+    }
+
+    bool erase(NodeID id)
+    {
+        if (bitmap)
+        {
+            if (!bitmap->erase(id))
+                return false;
+
+            if (bitmap->size() < DEMOTE_AT)
+                demote();
+            return true;
+        }
+
+        if (packed)
+        {
+            if (!packed->contains(id))
+                return false;
+            unpack();
+        }
+
+        auto it = std::lower_bound(members.begin(), members.end(), id);
+        if (it == members.end() || *it != id)
+            return false;
+
+        members.erase(it);
+        return true;
+    }
+
+    bool contains(NodeID id) const
+    {
+        if (bitmap)
+            return bitmap->contains(id);
+        if (packed)
+            return packed->contains(id);
+        return std::binary_search(members.begin(), members.end(), id);
+    }
+
+    size_t size() const
+    {
+        if (bitmap)
+            return bitmap->size();
+        return packed ? packed->size() : members.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // The i-th smallest member (i < size()), without iterating up to it
+    NodeID at(size_t i) const
+    {
+        if (bitmap)
+            return bitmap->at(i);
+        return packed ? packed->at(i) : members[i];
+    }
+
+    void clear()
+    {
+        members.clear();
+        bitmap.reset();
+        packed.reset();
+    }
+
+    // Packs a small set into delta-encoded blocks until its next change.
+    // Returns false when there is nothing worth packing.
+    bool compress()
+    {
+        if (bitmap || packed || members.size() < PACK_MIN)
+            return false;
+
+        packed.reset(new PackedIDList(members.data(), members.size()));
+        std::vector<NodeID>().swap(members);
+        return true;
+    }
+
+    bool isCompressed() const
+    {
+        return packed != nullptr;
+    }
+
+    const_iterator begin() const
+    {
+        if (bitmap)
+            return const_iterator(bitmap->begin());
+        if (packed)
+            return const_iterator(packed->begin());
+        return const_iterator(members.data());
+    }
+
+    const_iterator end() const
+    {
+        if (bitmap)
+            return const_iterator(bitmap->end());
+        if (packed)
+            return const_iterator(packed->end());
+        return const_iterator(members.data() + members.size());
+    }
+
+    // Members in ascending order
+    std::vector<NodeID> toVector() const
+    {
+        if (bitmap)
+            return bitmap->toVector();
+        return packed ? packed->toVector() : members;
+    }
+
+    // Members of both sets into out, ascending
+    void intersect(const AdjacencySet &other, std::vector<NodeID> &out) const
+    {
+        out.clear();
+        if (!bitmap && !other.bitmap)
+        {
+            std::vector<NodeID> scratchA, scratchB;
+            const std::vector<NodeID> &a = sortedIDs(scratchA);
+            const std::vector<NodeID> &b = other.sortedIDs(scratchB);
+            out.resize(std::min(a.size(), b.size()));
+            out.resize(intersectSortedIDs(a.data(), a.size(), b.data(), b.size(), out.data()));
+            return;
+        }
+
+        if (bitmap && other.bitmap)
+        {
+            out = (*bitmap & *other.bitmap).toVector();
+            return;
+        }
+
+        // Small vector against a bitmap: probe each member
+        const AdjacencySet &small = bitmap ? other : *this;
+        const AdjacencySet &large = bitmap ? *this : other;
+        for (NodeID id : small)
+        {
+            if (large.bitmap->contains(id))
+                out.push_back(id);
+        }
+    }
+
+    size_t intersectionSize(const AdjacencySet &other) const
+    {
+        if (!bitmap && !other.bitmap)
+        {
+            std::vector<NodeID> scratchA, scratchB;
+            const std::vector<NodeID> &a = sortedIDs(scratchA);
+            const std::vector<NodeID> &b = other.sortedIDs(scratchB);
+            return intersectSortedIDs(a.data(), a.size(), b.data(), b.size(), nullptr);
+        }
+
+        if (bitmap && other.bitmap)
+            return bitmap->intersectionSize(*other.bitmap);
+
+        const AdjacencySet &small = bitmap ? other : *this;
+        const AdjacencySet &large = bitmap ? *this : other;
+        size_t count = 0;
+        for (NodeID id : small)
+            count += large.bitmap->contains(id);
+        return count;
+    }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this);
+        if (bitmap)
+        {
+            u += bitmap->memoryUsage();
+            return u;
+        }
+        if (packed)
+        {
+            u += packed->memoryUsage();
+            return u;
+        }
+
+        u.slotsUsed = members.size();
+        u.slotsTotal = members.capacity();
+        addOwnedMemory(u, members);
+        return u;
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "hash_map.hpp"
+#include <mutex>
+#include <shared_mutex>
+
+// Thread-safe HashMap: keys are spread over SHARDS independent HashMaps, each
+// behind its own reader/writer lock, so threads touching different shards never
+// contend and readers of one shard run in parallel.
+//
+// Values are never handed out by pointer (a concurrent insert could rehash the
+// shard under it). Read through get() (copy out) or visit(), which runs the
+// callback while the shard lock is held.
+template <typename K, typename V, typename H = Hash<K>, size_t SHARDS = 16>
+class ConcurrentHashMap
+{
+private:
+    static_assert((SHARDS & (SHARDS - 1)) == 0, "SHARDS must be a power of two");
+
+    // One cache line per lock so neighbouring shards do not false-share
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex lock;
+        HashMap<K, V, H> map;
+    };
+
+    Shard shards[SHARDS];
+
+    // Top hash bits pick the shard; HashMap uses the low bits inside it
+    Shard &shardFor(const K &key)
+    {
+        return shards[(H{}(key) >> (sizeof(size_t) * 4)) & (SHARDS - 1)];
+    }
+
+    const Shard &shardFor(const K &key) const
+    {
+        return shards[(H{}(key) >> (sizeof(size_t) * 4)) & (SHARDS - 1)];
+    }
+
+public:
+    ConcurrentHashMap() = default;
+
+    ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+    ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+    bool insert(const K &key, const V &val)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.insert(key, val);
+    }
+
+    template <typename VV>
+    bool insert_or_assign(const K &key, VV &&val)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.insert_or_assign(key, std::forward<VV>(val));
+    }
+
+    // true if the value was constructed (key was absent)
+    template <typename... Args>
+    bool try_emplace(const K &key, Args &&...args)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.try_emplace(key, std::forward<Args>(args)...).second;
+    }
+
+    bool remove(const K &key)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        return s.map.remove(key);
+    }
+
+    bool contains(const K &key) const
+    {
+        const Shard &s = shardFor(key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        return s.map.contains(key);
+    }
+
+    // Copies the value into out; false if absent
+    bool get(const K &key, V &out) const
+    {
+        const Shard &s = shardFor(key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        const V *v = s.map.get(key);
+        if (!v)
+            return false;
+
+        out = *v;
+        return true;
+    }
+
+    // Runs fn(const V &) under the shard's read lock; false if absent.
+    // fn must not call back into this map.
+    template <typename Fn>
+    bool visit(const K &key, Fn &&fn) const
+    {
+        const Shard &s = shardFor(key);
+        std::shared_lock<std::shared_mutex> guard(s.lock);
+        const V *v = s.map.get(key);
+        if (!v)
+            return false;
+
+        fn(*v);
+        return true;
+    }
+
+    // Runs fn(V &) under the shard's write lock; false if absent
+    template <typename Fn>
+    bool visit(const K &key, Fn &&fn)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        V *v = s.map.get(key);
+        if (!v)
+            return false;
+
+        fn(*v);
+        return true;
+    }
+
+    // Locked replacement for operator[]: default-constructs a missing value, then runs fn(V &)
+    template <typename Fn>
+    void update(const K &key, Fn &&fn)
+    {
+        Shard &s = shardFor(key);
+        std::unique_lock<std::shared_mutex> guard(s.lock);
+        fn(s.map[key]);
+    }
+
+    // Runs fn(const K &, const V &) for every entry, one shard (read-locked) at a time.
+    // Not a snapshot: entries in other shards may change meanwhile.
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        for (const Shard &s : shards)
+        {
+            std::shared_lock<std::shared_mutex> guard(s.lock);
+            for (auto it = s.map.begin(); it != s.map.end(); ++it)
+                fn((*it).key, (*it).value);
+        }
+    }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (const Shard &s : shards)
+        {
+            std::shared_lock<std::shared_mutex> guard(s.lock);
+            total += s.map.size();
+        }
+        return total;
+    }
+
+    void clear()
+    {
+        for (Shard &s : shards)
+        {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            s.map.clear();
+        }
+    }
+
+    void reserve(size_t total)
+    {
+        for (Shard &s : shards)
+        {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            s.map.reserve(total / SHARDS + 1);
+        }
+    }
+
+    // Sum over shards, each read-locked in turn
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        for (const Shard &s : shards)
+        {
+            std::shared_lock<std::shared_mutex> guard(s.lock);
+            u += s.map.memoryUsage();
+        }
+        u.metadataBytes += sizeof(*this) - SHARDS * sizeof(HashMap<K, V, H>);
+        return u;
+    }
+
+    void setIncrementalRehash(bool enabled, size_t slotsPerStep = 64)
+    {
+        for (Shard &s : shards)
+        {
+            std::unique_lock<std::shared_mutex> guard(s.lock);
+            s.map.setIncrementalRehash(enabled, slotsPerStep);
+        }
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "adjacency_set.hpp"
+#include "hash_map.hpp"
+#include "memory_usage.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Read-only compressed-sparse-row copy of a Graph, built by
+// Graph::buildCSRSnapshot(). Nodes are renumbered 0..n-1 in ascending NodeID
+// order and every node's neighbours are one ascending slice of a shared flat
+// array, so traversals walk contiguous memory and keep per-node state in
+// plain vectors indexed by dense ID instead of hash sets.
+class CSRGraph
+{
+public:
+    using DenseID = uint32_t;
+    static constexpr DenseID NONE = UINT32_MAX;
+
+    // A node's neighbours: a contiguous, ascending run of dense IDs
+    struct Range
+    {
+        const DenseID *first;
+        const DenseID *last;
+
+        const DenseID *begin() const { return first; }
+        const DenseID *end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    // The snapshot's numbering on its own. Results computed on a snapshot
+    // hold this instead of the whole graph, so they keep resolving users
+    // without pinning its edge arrays once a newer snapshot replaces it.
+    class NodeIndex
+    {
+    private:
+        friend class Graph;
+
+        std::vector<NodeID> ids;        // dense -> NodeID, ascending
+        HashMap<NodeID, DenseID> dense; // NodeID -> dense
+
+    public:
+        size_t size() const
+        {
+            return ids.size();
+        }
+
+        // NONE when the node did not exist at snapshot time
+        DenseID denseID(NodeID id) const
+        {
+            const DenseID *d = dense.get(id);
+            return d ? *d : NONE;
+        }
+
+        NodeID nodeID(DenseID d) const
+        {
+            return ids[d];
+        }
+
+        MemoryUsage memoryUsage() const
+        {
+            MemoryUsage u = dense.memoryUsage();
+            u.metadataBytes += sizeof(*this) - sizeof(dense);
+            addOwnedMemory(u, ids);
+            return u;
+        }
+    };
+
+private:
+    friend class Graph;
+
+    std::shared_ptr<const NodeIndex> index;
+    std::vector<size_t> outOffsets; // node d's out-edges are outTargets[outOffsets[d], outOffsets[d + 1])
+    std::vector<DenseID> outTargets;
+    std::vector<size_t> inOffsets;
+    std::vector<DenseID> inTargets;
+
+public:
+    size_t nodeCount() const
+    {
+        return index->size();
+    }
+
+    size_t edgeCount() const
+    {
+        return outTargets.size();
+    }
+
+    // NONE when the node did not exist at snapshot time
+    DenseID denseID(NodeID id) const
+    {
+        return index->denseID(id);
+    }
+
+    NodeID nodeID(DenseID d) const
+    {
+        return index->nodeID(d);
+    }
+
+    std::shared_ptr<const NodeIndex> nodeIndex() const
+    {
+        return index;
+    }
+
+    Range outNeighbors(DenseID d) const
+    {
+        return {outTargets.data() + outOffsets[d], outTargets.data() + outOffsets[d + 1]};
+    }
+
+    Range inNeighbors(DenseID d) const
+    {
+        return {inTargets.data() + inOffsets[d], inTargets.data() + inOffsets[d + 1]};
+    }
+
+    size_t outDegree(DenseID d) const
+    {
+        return outOffsets[d + 1] - outOffsets[d];
+    }
+
+    size_t inDegree(DenseID d) const
+    {
+        return inOffsets[d + 1] - inOffsets[d];
+    }
+
+    // Tarjan's strongly connected components with an explicit stack, so
+    // long follow chains cannot overflow the call stack. component[d] is
+    // node d's component; IDs come out in reverse topological order (a
+    // component's successors get smaller IDs). Returns the component count.
+    size_t stronglyConnectedComponents(std::vector<uint32_t> &component) const
+    {
+        std::vector<DenseID> all(nodeCount());
+        for (size_t d = 0; d < all.size(); d++)
+            all[d] = static_cast<DenseID>(d);
+
+        component.assign(nodeCount(), 0);
+        return stronglyConnectedComponents(all, [](DenseID)
+                                           { return true; }, component);
+    }
+
+    // The same over the subgraph induced by nodes, where inside(d) says
+    // whether d is one of them. component must hold an entry per dense ID;
+    // only the entries of nodes are written. Costs O(nodes + their edges).
+    template <typename Inside>
+    size_t stronglyConnectedComponents(const std::vector<DenseID> &nodes, Inside &&inside,
+                                       std::vector<uint32_t> &component) const
+    {
+        const uint32_t UNVISITED = UINT32_MAX;
+        size_t m = nodes.size();
+
+        // While running, component[d] is d's slot in nodes
+        for (size_t i = 0; i < m; i++)
+            component[nodes[i]] = static_cast<uint32_t>(i);
+
+        std::vector<uint32_t> order(m, UNVISITED); // DFS discovery index
+        std::vector<uint32_t> low(m);
+        std::vector<uint32_t> result(m);
+        std::vector<char> onStack(m, 0);
+        std::vector<uint32_t> members; // Tarjan's stack of open slots
+
+        struct Frame
+        {
+            uint32_t slot;
+            size_t edge; // next out-edge to look at
+        };
+        std::vector<Frame> calls;
+
+        uint32_t nextOrder = 0;
+        uint32_t components = 0;
+
+        for (uint32_t root = 0; root < m; root++)
+        {
+            if (order[root] != UNVISITED)
+                continue;
+
+            calls.push_back({root, outOffsets[nodes[root]]});
+            order[root] = low[root] = nextOrder++;
+            members.push_back(root);
+            onStack[root] = 1;
+
+            while (!calls.empty())
+            {
+                Frame &f = calls.back();
+                uint32_t v = f.slot;
+
+                if (f.edge < outOffsets[nodes[v] + 1])
+                {
+                    DenseID target = outTargets[f.edge++];
+                    if (!inside(target))
+                        continue;
+
+                    uint32_t w = component[target];
+                    if (order[w] == UNVISITED)
+                    {
+                        order[w] = low[w] = nextOrder++;
+                        members.push_back(w);
+                        onStack[w] = 1;
+                        calls.push_back({w, outOffsets[target]}); // f is invalid from here
+                    }
+                    else if (onStack[w] && order[w] < low[v])
+                    {
+                        low[v] = order[w];
+                    }
+                    continue;
+                }
+
+                // v is finished: close its component if it is the root
+                if (low[v] == order[v])
+                {
+                    uint32_t w;
+                    do
+                    {
+                        w = members.back();
+                        members.pop_back();
+                        onStack[w] = 0;
+                        result[w] = components;
+                    } while (w != v);
+                    components++;
+                }
+
+                calls.pop_back();
+                if (!calls.empty() && low[v] < low[calls.back().slot])
+                    low[calls.back().slot] = low[v];
+            }
+        }
+
+        for (size_t i = 0; i < m; i++)
+            component[nodes[i]] = result[i];
+        return components;
+    }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u = index->memoryUsage();
+        u.metadataBytes += sizeof(*this);
+        addOwnedMemory(u, outOffsets);
+        addOwnedMemory(u, outTargets);
+        addOwnedMemory(u, inOffsets);
+        addOwnedMemory(u, inTargets);
+        return u;
+    }
+};
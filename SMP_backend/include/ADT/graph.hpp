@@ -1,23 +1,56 @@
 #pragma once
 
+#include "adjacency_set.hpp"
+#include "csr_graph.hpp"
 #include "hash_map.hpp"
 #include "set.hpp"
+#include <algorithm>
 #include <vector>
 
-using NodeID = unsigned long long;
-
 class Graph
 {
 private:
-    HashMap<NodeID, Set<NodeID>> outAdj;
-    HashMap<NodeID, Set<NodeID>> inAdj;
+    HashMap<NodeID, AdjacencySet> outAdj;
+    HashMap<NodeID, AdjacencySet> inAdj;
+
+    // Adjacency maps hold every node, so spread their resizes over later inserts
+    void enableIncrementalRehash()
+    {
+        outAdj.setIncrementalRehash(true);
+        inAdj.setIncrementalRehash(true);
+    }
+
+    // One direction of the snapshot: each node's set, in dense order, remapped
+    static void fillCSR(const HashMap<NodeID, AdjacencySet> &adj, const CSRGraph::NodeIndex &index,
+                        std::vector<size_t> &offsets, std::vector<CSRGraph::DenseID> &targets)
+    {
+        size_t edges = 0;
+        for (auto it = adj.begin(); it != adj.end(); ++it)
+            edges += (*it).value.size();
+
+        offsets.reserve(index.ids.size() + 1);
+        targets.reserve(edges);
+        for (NodeID id : index.ids)
+        {
+            offsets.push_back(targets.size());
+            const AdjacencySet *s = adj.get(id);
+            if (!s)
+                continue;
+
+            // Dense IDs follow NodeID order, so the slice stays ascending
+            for (NodeID n : *s)
+                targets.push_back(*index.dense.get(n));
+        }
+        offsets.push_back(targets.size());
+    }
 
 public:
-    Graph() {}
+    Graph() { enableIncrementalRehash(); }
     Graph(size_t reserveNodes)
     {
         outAdj.reserve(reserveNodes);
         inAdj.reserve(reserveNodes);
+        enableIncrementalRehash();
     }
 
     bool addEdge(NodeID from, NodeID to)
@@ -48,10 +81,8 @@ public:
 
     bool hasEdge(NodeID from, NodeID to) const
     {
-        if (!outAdj.contains(from))
-            return false;
-
-        return outAdj.get(from)->contains(to);
+        const AdjacencySet *s = outAdj.get(from);
+        return s && s->contains(to);
     }
 
     bool hasNode(NodeID id)
@@ -76,25 +107,41 @@ public:
         return created;
     }
 
-    const Set<NodeID> *outNeighbors(NodeID from) const
+    // Every node once; addNode registers a node in both maps
+    size_t nodeCount() const
     {
-        if (!outAdj.contains(from))
-            return nullptr;
+        return outAdj.size();
+    }
 
-        return outAdj.get(from);
+    template <typename F>
+    void forEachNode(F &&visit) const
+    {
+        for (auto it = outAdj.begin(); it != outAdj.end(); ++it)
+            visit((*it).key);
     }
 
-    const Set<NodeID> *inNeighbors(NodeID to) const
+    std::vector<NodeID> nodes() const
     {
-        if (!inAdj.contains(to))
-            return nullptr;
+        std::vector<NodeID> ids;
+        ids.reserve(outAdj.size());
+        forEachNode([&](NodeID id)
+                    { ids.push_back(id); });
+        return ids;
+    }
 
+    const AdjacencySet *outNeighbors(NodeID from) const
+    {
+        return outAdj.get(from);
+    }
+
+    const AdjacencySet *inNeighbors(NodeID to) const
+    {
         return inAdj.get(to);
     }
 
     size_t outDegree(NodeID from) const
     {
-        const Set<NodeID> *s = outAdj.get(from);
+        const AdjacencySet *s = outAdj.get(from);
         if (!s)
             return 0;
         return s->size();
@@ -102,12 +149,55 @@ public:
 
     size_t inDegree(NodeID to) const
     {
-        const Set<NodeID> *s = inAdj.get(to);
+        const AdjacencySet *s = inAdj.get(to);
         if (!s)
             return 0;
         return s->size();
     }
 
+    // Packs a node's neighbour sets (see AdjacencySet::compress) until they
+    // next change. Returns how many sets were packed.
+    size_t compressNode(NodeID id)
+    {
+        size_t packed = 0;
+        AdjacencySet *out = outAdj.get(id);
+        AdjacencySet *in = inAdj.get(id);
+        if (out && out->compress())
+            packed++;
+        if (in && in->compress())
+            packed++;
+        return packed;
+    }
+
+    size_t compressAll()
+    {
+        size_t packed = 0;
+        for (auto it = outAdj.begin(); it != outAdj.end(); ++it)
+            packed += (*it).value.compress();
+        for (auto it = inAdj.begin(); it != inAdj.end(); ++it)
+            packed += (*it).value.compress();
+        return packed;
+    }
+
+    // Immutable CSR copy of the current nodes and edges. Later changes to the
+    // graph do not show up in it; callers rebuild when they need them.
+    CSRGraph buildCSRSnapshot() const
+    {
+        auto index = std::make_shared<CSRGraph::NodeIndex>();
+        index->ids = nodes();
+        std::sort(index->ids.begin(), index->ids.end());
+
+        index->dense.reserve(index->ids.size());
+        for (size_t d = 0; d < index->ids.size(); d++)
+            index->dense.insert(index->ids[d], static_cast<CSRGraph::DenseID>(d));
+
+        CSRGraph csr;
+        fillCSR(outAdj, *index, csr.outOffsets, csr.outTargets);
+        fillCSR(inAdj, *index, csr.inOffsets, csr.inTargets);
+        csr.index = std::move(index);
+        return csr;
+    }
+
     void clear()
     {
         outAdj.clear();
@@ -119,4 +209,13 @@ public:
         outAdj.reserve(sz);
         inAdj.reserve(sz);
     }
+
+    // Both adjacency maps including every neighbour set
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u = outAdj.memoryUsage();
+        u += inAdj.memoryUsage();
+        u.metadataBytes += sizeof(*this) - sizeof(outAdj) - sizeof(inAdj);
+        return u;
+    }
 };
\ No newline at end of file
@@ -1,304 +1,833 @@
 #pragma once
 
-#include <vector>
+#include "memory_usage.hpp"
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASHMAP_SSE2 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HASHMAP_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(HASHMAP_SSE2)
+#define HASHMAP_PREFETCH(p) _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#else
+#define HASHMAP_PREFETCH(p) ((void)0)
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ---------------- Hash functions ----------------
+
+// 64x64 -> 128-bit multiply, folded back to 64 bits
+inline uint64_t hashMum(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return lo ^ hi;
+#endif
+}
+
+// Multiply-shift finaliser (murmur3 fmix64): every input bit affects every output bit,
+// so sequential IDs spread over the whole table
+inline uint64_t hashMix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t hashRead8(const char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t hashRead4(const char *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+// wyhash-style byte hash: 16 bytes per multiply, short keys read with overlapping loads
+inline uint64_t hashBytes(const char *p, size_t len, uint64_t seed = 0)
+{
+    const uint64_t s0 = 0xa0761d6478bd642fULL, s1 = 0xe7037ed1a0b428dbULL;
+    const uint64_t s2 = 0x8ebc6af09c88c6e3ULL, s3 = 0x589965cc75374cc3ULL;
+
+    seed ^= hashMum(seed ^ s0, s1);
+    uint64_t a, b;
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            size_t off = (len >> 3) << 2;
+            a = (hashRead4(p) << 32) | hashRead4(p + off);
+            b = (hashRead4(p + len - 4) << 32) | hashRead4(p + len - 4 - off);
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)(unsigned char)p[0] << 16) |
+                ((uint64_t)(unsigned char)p[len >> 1] << 8) |
+                (uint64_t)(unsigned char)p[len - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = hashMum(hashRead8(p) ^ s1, hashRead8(p + 8) ^ seed);
+                see1 = hashMum(hashRead8(p + 16) ^ s2, hashRead8(p + 24) ^ see1);
+                see2 = hashMum(hashRead8(p + 32) ^ s3, hashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = hashMum(hashRead8(p) ^ s1, hashRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = hashRead8(p + i - 16);
+        b = hashRead8(p + i - 8);
+    }
+
+    return hashMum(s1 ^ len, hashMum(a ^ s1, b ^ seed));
+}
 
+// Default hash policy; HashMap/Set take any functor with the same shape as a
+// third template argument
 template <typename T>
-class LL
+struct Hash
+{
+    size_t operator()(const T &key) const
+    {
+        return (size_t)hashMix64((uint64_t)key);
+    }
+};
+template <>
+struct Hash<const char *>
+{
+    size_t operator()(const char *str) const
+    {
+        return (size_t)hashBytes(str, std::strlen(str));
+    }
+};
+// Transparent: std::string, std::string_view and const char * hash identically,
+// so string-keyed maps can be probed without building a std::string
+template <>
+struct Hash<std::string>
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const
+    {
+        return (size_t)hashBytes(str.data(), str.size());
+    }
+    size_t operator()(const std::string &str) const
+    {
+        return (size_t)hashBytes(str.data(), str.size());
+    }
+    size_t operator()(const char *str) const
+    {
+        return (size_t)hashBytes(str, std::strlen(str));
+    }
+};
+
+// 16 consecutive control bytes, matched in one step with SSE2
+// (or a plain loop where SSE2 is unavailable). Bit i of a mask = byte i.
+struct CtrlGroup
+{
+    static constexpr size_t WIDTH = 16;
+    static constexpr signed char EMPTY = -128;
+    static constexpr signed char DELETED = -2;
+
+#ifdef HASHMAP_SSE2
+    __m128i bytes;
+
+    explicit CtrlGroup(const signed char *p)
+        : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+
+    unsigned match(signed char tag) const
+    {
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), bytes));
+    }
+
+    // EMPTY and DELETED are the only negative control values
+    unsigned matchFree() const
+    {
+        return (unsigned)_mm_movemask_epi8(bytes);
+    }
+#else
+    const signed char *bytes;
+
+    explicit CtrlGroup(const signed char *p) : bytes(p) {}
+
+    unsigned match(signed char tag) const
+    {
+        unsigned mask = 0;
+        for (size_t i = 0; i < WIDTH; i++)
+        {
+            if (bytes[i] == tag)
+                mask |= 1u << i;
+        }
+        return mask;
+    }
+
+    unsigned matchFree() const
+    {
+        unsigned mask = 0;
+        for (size_t i = 0; i < WIDTH; i++)
+        {
+            if (bytes[i] < 0)
+                mask |= 1u << i;
+        }
+        return mask;
+    }
+#endif
+
+    unsigned matchEmpty() const { return match(EMPTY); }
+
+    // mask is never 0
+    static unsigned lowestBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(mask);
+#endif
+    }
+};
+
+// Open-addressing hash table (linear probing, one control group at a time).
+// Entries live in one contiguous slot array; a parallel control byte per slot
+// records EMPTY, DELETED (tombstone) or, for a full slot, a 7-bit tag taken
+// from the hash so most mismatching slots are rejected without a key compare.
+// The first WIDTH-1 control bytes are mirrored past the end so a group load
+// starting near the end of the table wraps without a branch.
+// Capacity is always a power of two: the low 7 hash bits form the tag and the
+// remaining bits, masked, pick the home slot.
+//
+// With setIncrementalRehash(true) a resize allocates the bigger table and then
+// moves a bounded number of old slots per insert/remove instead of all at
+// once. Until the old table drains, lookups check the new table first and
+// then the old one; new keys always go to the new table.
+template <typename K, typename V, typename H = Hash<K>>
+class HashMap
 {
 private:
     struct Node
     {
-        T value;
-        Node *next;
-        Node(const T &val) : value(val), next(nullptr) {}
+        K key;
+        V value;
+
+        // Key and value are built in place from their own argument lists
+        template <typename KK, typename... Args>
+        Node(std::piecewise_construct_t, KK &&k, Args &&...args)
+            : key(std::forward<KK>(k)), value(std::forward<Args>(args)...) {}
     };
 
-    Node *head;
+    static constexpr signed char EMPTY = CtrlGroup::EMPTY;
+    static constexpr signed char DELETED = CtrlGroup::DELETED;
+    static constexpr size_t GROUP = CtrlGroup::WIDTH;
+    static constexpr size_t BATCH = 16; // keys hashed and prefetched ahead in getMany
 
-public:
-    LL() : head(nullptr) {}
-    ~LL() { clear(); }
+    struct Table
+    {
+        Node *slots = nullptr;
+        signed char *ctrl = nullptr;
+        size_t capacity = 0;
+    };
+
+    Table table;       // live table; every new key lands here
+    Table old;         // table being drained by an incremental rehash (capacity 0 if none)
+    size_t oldPos;     // next old slot to migrate
+    size_t currSize;   // entries in both tables
+    size_t tombstones; // DELETED slots in table
+    float loadFactorThreshold;
+    size_t rehashStep; // old slots migrated per mutation; 0 = rehash all at once
+
+    static bool isFull(signed char c) { return c >= 0; }
+    static signed char tagOf(size_t h) { return (signed char)(h & 0x7F); }
+    static size_t homeOf(const Table &t, size_t h) { return (h >> 7) & (t.capacity - 1); }
 
-    void insert(const T &val)
+    template <typename Q>
+    size_t hashKey(const Q &key) const
     {
-        Node *n = new Node(val);
-        n->next = head;
-        head = n;
+        return H{}(key);
     }
 
-    // remove by key only
-    bool remove(const typename T::KeyType &key)
+    static size_t roundUpCapacity(size_t cap)
     {
-        Node *prev = nullptr;
-        Node *curr = head;
+        size_t p = GROUP;
+        while (p < cap)
+            p <<= 1;
+        return p;
+    }
+
+    static Table makeTable(size_t cap)
+    {
+        Table t;
+        if (cap == 0)
+            return t;
+
+        t.capacity = roundUpCapacity(cap);
+        t.slots = static_cast<Node *>(::operator new(sizeof(Node) * t.capacity));
+        t.ctrl = new signed char[t.capacity + GROUP - 1];
+        for (size_t i = 0; i < t.capacity + GROUP - 1; i++)
+            t.ctrl[i] = EMPTY;
+        return t;
+    }
 
-        while (curr)
+    static void freeTable(Table &t)
+    {
+        for (size_t i = 0; i < t.capacity; i++)
         {
-            if (curr->value.key == key)
-            {
-                if (prev)
-                    prev->next = curr->next;
-                else
-                    head = curr->next;
+            if (isFull(t.ctrl[i]))
+                t.slots[i].~Node();
+        }
+        ::operator delete(t.slots);
+        delete[] t.ctrl;
+        t = Table();
+    }
+
+    void accountTable(const Table &t, MemoryUsage &u) const
+    {
+        if (t.capacity == 0)
+            return;
+
+        u.metadataBytes += t.capacity + GROUP - 1; // control bytes
+        u.slotsTotal += t.capacity;
 
-                delete curr;
-                return true;
+        for (size_t i = 0; i < t.capacity; i++)
+        {
+            if (!isFull(t.ctrl[i]))
+            {
+                u.overheadBytes += sizeof(Node);
+                continue;
             }
-            prev = curr;
-            curr = curr->next;
+
+            const Node &n = t.slots[i];
+            u.payloadBytes += sizeof(Node);
+            u.slotsUsed++;
+            addOwnedMemory(u, n.key);
+            addOwnedMemory(u, n.value);
+
+            size_t probe = ((i - homeOf(t, hashKey(n.key))) & (t.capacity - 1)) / GROUP + 1;
+            if (probe > u.longestProbe)
+                u.longestProbe = probe;
         }
-        return false;
     }
 
-    T *find(const typename T::KeyType &key)
+    static void setCtrl(Table &t, size_t idx, signed char c)
     {
-        Node *curr = head;
-        while (curr)
+        t.ctrl[idx] = c;
+        if (idx < GROUP - 1)
+            t.ctrl[t.capacity + idx] = c;
+    }
+
+    // Slot of t holding key, or t.capacity if absent
+    template <typename Q>
+    static size_t findIn(const Table &t, const Q &key, size_t h)
+    {
+        if (t.capacity == 0)
+            return 0;
+
+        signed char tag = tagOf(h);
+        size_t mask = t.capacity - 1;
+        size_t idx = homeOf(t, h);
+
+        for (size_t scanned = 0; scanned < t.capacity; scanned += GROUP)
         {
-            if (curr->value.key == key)
-                return &curr->value;
-            curr = curr->next;
+            CtrlGroup g(t.ctrl + idx);
+
+            for (unsigned m = g.match(tag); m; m &= m - 1)
+            {
+                size_t pos = (idx + CtrlGroup::lowestBit(m)) & mask;
+                if (t.slots[pos].key == key)
+                    return pos;
+            }
+
+            if (g.matchEmpty())
+                return t.capacity;
+
+            idx = (idx + GROUP) & mask;
         }
-        return nullptr;
+        return t.capacity;
     }
 
-    const T *find(const typename T::KeyType &key) const
+    // First reusable slot on the probe path of h; caller guarantees the key is absent
+    static size_t findFreeIn(const Table &t, size_t h)
     {
-        Node *curr = head;
-        while (curr)
+        size_t mask = t.capacity - 1;
+        size_t idx = homeOf(t, h);
+        while (true)
         {
-            if (curr->value.key == key)
-                return &curr->value;
-            curr = curr->next;
+            unsigned m = CtrlGroup(t.ctrl + idx).matchFree();
+            if (m)
+                return (idx + CtrlGroup::lowestBit(m)) & mask;
+
+            idx = (idx + GROUP) & mask;
         }
-        return nullptr;
     }
 
-    Node *begin() { return head; }
-    const Node *begin() const { return head; }
+    // Table holding key (table or old) with its slot in idx, or nullptr
+    template <typename Q>
+    Table *locate(const Q &key, size_t &idx) const
+    {
+        return locate(key, hashKey(key), idx);
+    }
 
-    void clear()
+    template <typename Q>
+    Table *locate(const Q &key, size_t h, size_t &idx) const
     {
-        Node *curr = head;
-        while (curr)
-        {
-            Node *next = curr->next;
-            delete curr;
-            curr = next;
-        }
-        head = nullptr;
+        if (currSize == 0)
+            return nullptr;
+
+        Table *live = const_cast<Table *>(&table);
+        idx = findIn(*live, key, h);
+        if (idx < live->capacity)
+            return live;
+
+        if (old.capacity == 0)
+            return nullptr;
+
+        Table *draining = const_cast<Table *>(&old);
+        idx = findIn(*draining, key, h);
+        return idx < draining->capacity ? draining : nullptr;
     }
 
-    // -------- Iterator ----------
-    struct iterator
+    template <typename Q>
+    Node *findNode(const Q &key) const
     {
-        Node *ptr;
-        iterator() : ptr(nullptr) {}
-        iterator(Node *p) : ptr(p) {}
+        size_t idx;
+        Table *t = locate(key, idx);
+        return t ? &t->slots[idx] : nullptr;
+    }
 
-        T &operator*() { return ptr->value; }
-        iterator &operator++()
+    // Hash and prefetch the home group of a whole batch before probing any of it,
+    // so the batch's cache misses overlap instead of being paid one after another
+    template <typename Out>
+    void lookupBatch(const K *keys, size_t n, Out *out) const
+    {
+        size_t hashes[BATCH];
+
+        for (size_t base = 0; base < n; base += BATCH)
         {
-            ptr = ptr->next;
-            return *this;
+            size_t count = n - base < BATCH ? n - base : BATCH;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                hashes[i] = hashKey(keys[base + i]);
+                if (table.capacity != 0)
+                {
+                    size_t home = homeOf(table, hashes[i]);
+                    HASHMAP_PREFETCH(table.ctrl + home);
+                    HASHMAP_PREFETCH(table.slots + home);
+                }
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t idx;
+                Table *t = locate(keys[base + i], hashes[i], idx);
+                out[base + i] = t ? &t->slots[idx].value : nullptr;
+            }
         }
-        bool operator!=(const iterator &other) const
+    }
+
+    // Move up to budget old slots into table; frees old once it is drained
+    void migrate(size_t budget)
+    {
+        for (size_t n = 0; n < budget && oldPos < old.capacity; n++, oldPos++)
         {
-            return ptr != other.ptr;
+            if (!isFull(old.ctrl[oldPos]))
+                continue;
+
+            Node &src = old.slots[oldPos];
+            size_t h = hashKey(src.key);
+            size_t idx = findFreeIn(table, h);
+            if (table.ctrl[idx] == DELETED)
+                tombstones--;
+
+            new (&table.slots[idx]) Node(std::move(src));
+            setCtrl(table, idx, tagOf(h));
+            src.~Node();
+            setCtrl(old, oldPos, DELETED);
         }
-        bool operator==(const iterator &other) const
+
+        if (old.capacity != 0 && oldPos == old.capacity)
         {
-            return ptr == other.ptr;
+            freeTable(old);
+            oldPos = 0;
         }
-    };
+    }
 
-    struct const_iterator
+    void finishRehash()
     {
-        const Node *ptr;
-        const_iterator() : ptr(nullptr) {}
-        const_iterator(const Node *p) : ptr(p) {}
+        migrate(old.capacity - oldPos);
+    }
 
-        const T &operator*() const { return ptr->value; }
-        const_iterator &operator++()
+    // Swap in a fresh table of newCap slots and start draining the current one
+    void startRehash(size_t newCap)
+    {
+        finishRehash();
+        old = table;
+        oldPos = 0;
+        table = makeTable(newCap);
+        tombstones = 0;
+        migrate(rehashStep == 0 ? old.capacity : rehashStep);
+    }
+
+    // Make room for one more entry; tombstone-heavy tables are cleaned in place
+    void maybeRehash()
+    {
+        if (table.capacity == 0)
         {
-            ptr = ptr->next;
-            return *this;
+            table = makeTable(GROUP);
+            return;
         }
-        bool operator!=(const const_iterator &other) const
+        float limit = (float)table.capacity * loadFactorThreshold;
+        if ((float)(currSize + tombstones + 1) <= limit)
+            return;
+
+        if ((float)(currSize + 1) <= limit / 2)
+            startRehash(table.capacity);
+        else
+            startRehash(table.capacity * 2);
+    }
+
+    // Place a key known to be absent, constructing its value from args; returns its node
+    template <typename KK, typename... Args>
+    Node *insertNew(KK &&key, Args &&...args)
+    {
+        maybeRehash();
+        migrate(rehashStep);
+
+        size_t h = hashKey(key);
+        size_t idx = findFreeIn(table, h);
+        if (table.ctrl[idx] == DELETED)
+            tombstones--;
+
+        new (&table.slots[idx]) Node(std::piecewise_construct, std::forward<KK>(key),
+                                     std::forward<Args>(args)...);
+        setCtrl(table, idx, tagOf(h));
+        currSize++;
+        return &table.slots[idx];
+    }
+
+    template <typename Q>
+    bool removeKey(const Q &key)
+    {
+        migrate(rehashStep);
+
+        size_t idx;
+        Table *t = locate(key, idx);
+        if (!t)
+            return false;
+
+        t->slots[idx].~Node();
+
+        // A slot followed by EMPTY ends no probe chain, so it can be EMPTY too
+        if (t == &table && table.ctrl[idx + 1] == EMPTY)
         {
-            return ptr != other.ptr;
+            setCtrl(table, idx, EMPTY);
         }
-        bool operator==(const const_iterator &other) const
+        else
         {
-            return ptr == other.ptr;
+            setCtrl(*t, idx, DELETED);
+            if (t == &table)
+                tombstones++;
         }
-    };
+        currSize--;
+        return true;
+    }
 
-    iterator begin_iter() { return iterator(head); }
-    iterator end_iter() { return iterator(nullptr); }
-    const_iterator begin_iter() const { return const_iterator(head); }
-    const_iterator end_iter() const { return const_iterator(nullptr); }
-};
+    size_t slotCount() const { return table.capacity + old.capacity; }
 
-template <typename T>
-struct Hash
-{
-    size_t operator()(const T &key)
+    bool fullAt(size_t i) const
     {
-        return (size_t)key;
+        return i < table.capacity ? isFull(table.ctrl[i])
+                                  : isFull(old.ctrl[i - table.capacity]);
     }
-};
-template <>
-struct Hash<const char *>
-{
-    size_t operator()(const char *str) const
+
+    Node &nodeAt(size_t i) const
     {
-        size_t h = 0;
-        while (*str)
-        {
-            h = h * 53 + (size_t)(*str);
-            str++;
-        }
-        return h;
+        return i < table.capacity ? table.slots[i] : old.slots[i - table.capacity];
     }
-};
-template <>
-struct Hash<std::string>
-{
-    size_t operator()(const std::string &str) const
+
+    // Iterator position of a located slot
+    size_t positionOf(const Table *t, size_t idx) const
+    {
+        return t == &table ? idx : table.capacity + idx;
+    }
+
+public:
+    HashMap(size_t cap = 20, float lf = 0.75)
+        : table(makeTable(cap)), oldPos(0), currSize(0), tombstones(0),
+          loadFactorThreshold(lf), rehashStep(0) {}
+
+    HashMap(const HashMap &other)
+        : table(makeTable(other.table.capacity)), oldPos(0), currSize(other.currSize),
+          tombstones(0), loadFactorThreshold(other.loadFactorThreshold),
+          rehashStep(other.rehashStep)
     {
-        size_t h = 0;
-        for (char c : str)
+        for (size_t i = 0; i < other.slotCount(); i++)
         {
-            h = h * 53 + c;
+            if (!other.fullAt(i))
+                continue;
+
+            const Node &src = other.nodeAt(i);
+            size_t h = hashKey(src.key);
+            size_t idx = findFreeIn(table, h);
+            new (&table.slots[idx]) Node(src);
+            setCtrl(table, idx, tagOf(h));
         }
-        return h;
     }
-};
 
-template <typename K, typename V>
-class HashMap
-{
-private:
-    struct Node
+    HashMap(HashMap &&other) noexcept
+        : table(other.table), old(other.old), oldPos(other.oldPos),
+          currSize(other.currSize), tombstones(other.tombstones),
+          loadFactorThreshold(other.loadFactorThreshold), rehashStep(other.rehashStep)
     {
-        using KeyType = K;
-        K key;
-        V value;
-    };
-
-    std::vector<LL<Node>> buckets;
-    size_t currSize;
-    float loadFactorThreshold;
+        other.table = Table();
+        other.old = Table();
+        other.oldPos = 0;
+        other.currSize = 0;
+        other.tombstones = 0;
+    }
 
-    size_t hashKey(const K &key, size_t mod) const
+    HashMap &operator=(HashMap other)
     {
-        return Hash<K>{}(key) % mod;
+        std::swap(table, other.table);
+        std::swap(old, other.old);
+        std::swap(oldPos, other.oldPos);
+        std::swap(currSize, other.currSize);
+        std::swap(tombstones, other.tombstones);
+        std::swap(loadFactorThreshold, other.loadFactorThreshold);
+        std::swap(rehashStep, other.rehashStep);
+        return *this;
     }
 
-    void rehash()
+    ~HashMap()
     {
-        size_t newSize = buckets.size() * 2;
-        std::vector<LL<Node>> newBuckets(newSize);
+        freeTable(table);
+        freeTable(old);
+    }
 
-        for (auto &chain : buckets)
+    // Spread resizes over later mutations, moving slotsPerStep old slots each time.
+    // Bounds worst-case insert latency on very large maps; off by default.
+    void setIncrementalRehash(bool enabled, size_t slotsPerStep = 64)
+    {
+        if (!enabled)
         {
-            for (auto it = chain.begin_iter(); it != chain.end_iter(); ++it)
-            {
-                Node &n = *it;
-                size_t index = hashKey(n.key, newSize);
-                newBuckets[index].insert(n);
-            }
+            finishRehash();
+            rehashStep = 0;
+            return;
         }
+        rehashStep = slotsPerStep < 2 ? 2 : slotsPerStep;
+    }
 
-        buckets.swap(newBuckets);
+    bool isRehashing() const
+    {
+        return old.capacity != 0;
     }
 
-    void maybeRehash()
+    // Insert or overwrite; true if the key was new
+    bool insert(const K &key, const V &val)
     {
-        if ((float)currSize / (float)buckets.size() > loadFactorThreshold)
-            rehash();
+        return insert_or_assign(key, val);
     }
 
-public:
-    HashMap(size_t cap = 20, float lf = 0.75)
-        : currSize(0), loadFactorThreshold(lf)
+    bool insert(K &&key, V &&val)
     {
-        buckets.resize(cap);
+        return insert_or_assign(std::move(key), std::move(val));
     }
 
-    bool insert(const K &key, const V &val)
+    template <typename VV>
+    bool insert_or_assign(const K &key, VV &&val)
     {
-        maybeRehash();
+        Node *n = findNode(key);
+        if (n)
+        {
+            n->value = std::forward<VV>(val);
+            return false;
+        }
 
-        size_t index = hashKey(key, buckets.size());
-        Node *found = buckets[index].find(key);
+        insertNew(key, std::forward<VV>(val));
+        return true;
+    }
 
-        if (found)
+    template <typename VV>
+    bool insert_or_assign(K &&key, VV &&val)
+    {
+        Node *n = findNode(key);
+        if (n)
         {
-            found->value = val;
+            n->value = std::forward<VV>(val);
             return false;
         }
 
-        buckets[index].insert(Node{key, val});
-        currSize++;
+        insertNew(std::move(key), std::forward<VV>(val));
         return true;
     }
 
+    // Construct the value from args only if key is absent; never overwrites.
+    // Returns the stored value and whether it was inserted.
+    template <typename... Args>
+    std::pair<V *, bool> try_emplace(const K &key, Args &&...args)
+    {
+        Node *n = findNode(key);
+        if (n)
+            return {&n->value, false};
+
+        return {&insertNew(key, std::forward<Args>(args)...)->value, true};
+    }
+
+    template <typename... Args>
+    std::pair<V *, bool> try_emplace(K &&key, Args &&...args)
+    {
+        Node *n = findNode(key);
+        if (n)
+            return {&n->value, false};
+
+        return {&insertNew(std::move(key), std::forward<Args>(args)...)->value, true};
+    }
+
+    // try_emplace with the key itself built from keyArg (e.g. std::string from const char *)
+    template <typename KK, typename... Args>
+    std::pair<V *, bool> emplace(KK &&keyArg, Args &&...args)
+    {
+        K key(std::forward<KK>(keyArg));
+        return try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
     bool remove(const K &key)
     {
-        size_t index = hashKey(key, buckets.size());
-        bool removed = buckets[index].remove(key);
-        if (removed)
-            currSize--;
-        return removed;
+        return removeKey(key);
     }
 
     bool contains(const K &key) const
     {
-        size_t index = hashKey(key, buckets.size());
-        return buckets[index].find(key) != nullptr;
+        return findNode(key) != nullptr;
     }
 
     V *get(const K &key)
     {
-        size_t index = hashKey(key, buckets.size());
-        Node *n = buckets[index].find(key);
+        Node *n = findNode(key);
         return n ? &n->value : nullptr;
     }
 
     const V *get(const K &key) const
     {
-        size_t index = hashKey(key, buckets.size());
-        const Node *n = buckets[index].find(key);
+        const Node *n = findNode(key);
         return n ? &n->value : nullptr;
     }
 
-    V &operator[](const K &key)
+    // Heterogeneous lookups (e.g. std::string_view into a std::string-keyed map),
+    // available when the hash policy declares is_transparent; nothing is converted to K
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    bool remove(const Q &key)
     {
-        maybeRehash();
+        return removeKey(key);
+    }
 
-        size_t index = hashKey(key, buckets.size());
-        Node *found = buckets[index].find(key);
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    bool contains(const Q &key) const
+    {
+        return findNode(key) != nullptr;
+    }
 
-        if (found)
-        {
-            return found->value;
-        }
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    V *get(const Q &key)
+    {
+        Node *n = findNode(key);
+        return n ? &n->value : nullptr;
+    }
 
-        buckets[index].insert(Node{key, V()});
-        currSize++;
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    const V *get(const Q &key) const
+    {
+        const Node *n = findNode(key);
+        return n ? &n->value : nullptr;
+    }
+
+    // Batched get(): out[i] = value stored for keys[i], or nullptr.
+    // Faster than a get() loop for large fan-outs (feeds, recommendations).
+    void getMany(const K *keys, size_t n, V **out)
+    {
+        lookupBatch(keys, n, out);
+    }
 
-        found = buckets[index].find(key);
-        return found->value;
+    void getMany(const K *keys, size_t n, const V **out) const
+    {
+        lookupBatch(keys, n, out);
+    }
+
+    std::vector<const V *> getMany(const std::vector<K> &keys) const
+    {
+        std::vector<const V *> out(keys.size());
+        lookupBatch(keys.data(), keys.size(), out.data());
+        return out;
+    }
+
+    V &operator[](const K &key)
+    {
+        Node *n = findNode(key);
+        if (n)
+            return n->value;
+
+        return insertNew(key)->value;
+    }
+
+    V &operator[](K &&key)
+    {
+        Node *n = findNode(key);
+        if (n)
+            return n->value;
+
+        return insertNew(std::move(key))->value;
     }
 
     const V &operator[](const K &key) const
     {
-        size_t index = hashKey(key, buckets.size());
-        const Node *found = buckets[index].find(key);
-        return found->value;
+        return findNode(key)->value;
     }
 
     size_t size() const
@@ -308,217 +837,160 @@ public:
 
     void clear()
     {
-        for (auto &chain : buckets)
+        for (size_t i = 0; i < table.capacity; i++)
         {
-            chain.clear();
+            if (isFull(table.ctrl[i]))
+                table.slots[i].~Node();
+            setCtrl(table, i, EMPTY);
         }
+        freeTable(old);
+        oldPos = 0;
         currSize = 0;
+        tombstones = 0;
     }
 
     void reserve(size_t newCap)
     {
-        if (newCap <= buckets.size())
+        if (newCap <= table.capacity)
             return;
 
-        std::vector<LL<Node>> newBuckets(newCap);
-
-        for (auto &chain : buckets)
-        {
-            for (auto it = chain.begin_iter(); it != chain.end_iter(); ++it)
-            {
-                Node &n = *it;
-                size_t index = hashKey(n.key, newCap);
-                newBuckets[index].insert(n);
-            }
-        }
+        size_t step = rehashStep;
+        rehashStep = 0;
+        startRehash(newCap);
+        rehashStep = step;
+    }
 
-        buckets.swap(newBuckets);
+    // Scans every slot of both tables: O(capacity)
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this);
+        accountTable(table, u);
+        accountTable(old, u);
+        return u;
     }
 
 public:
     struct iterator
     {
-        using LLNode = typename LL<Node>::iterator;
-
-        std::vector<LL<Node>> *buckets;
-        size_t bucketIndex;
-        LLNode chainIter;
-        LLNode chainEnd;
+        HashMap *map;
+        size_t index;
 
-        iterator(std::vector<LL<Node>> *b, size_t idx)
-            : buckets(b), bucketIndex(idx)
+        iterator(HashMap *m, size_t idx)
+            : map(m), index(idx)
         {
-            // Move to first non-empty bucket
-            while (bucketIndex < buckets->size() && (*buckets)[bucketIndex].begin() == nullptr)
-            {
-                bucketIndex++;
-            }
-
-            if (bucketIndex < buckets->size())
-            {
-                chainIter = (*buckets)[bucketIndex].begin_iter();
-                chainEnd = (*buckets)[bucketIndex].end_iter();
-            }
+            // Move to first full slot
+            while (index < map->slotCount() && !map->fullAt(index))
+                index++;
         }
 
         bool operator!=(const iterator &other) const
         {
-            return bucketIndex != other.bucketIndex ||
-                   chainIter != other.chainIter;
+            return index != other.index;
         }
 
         bool operator==(const iterator &other) const
         {
-            return bucketIndex == other.bucketIndex && chainIter == other.chainIter;
+            return index == other.index;
         }
 
         Node &operator*()
         {
-            return *chainIter;
+            return map->nodeAt(index);
         }
 
         iterator &operator++()
         {
-            ++chainIter;
-
-            if (chainIter == chainEnd)
-            {
-                bucketIndex++;
-                while (bucketIndex < buckets->size() &&
-                       (*buckets)[bucketIndex].begin() == nullptr)
-                {
-                    bucketIndex++;
-                }
-
-                if (bucketIndex < buckets->size())
-                {
-                    chainIter = (*buckets)[bucketIndex].begin_iter();
-                    chainEnd = (*buckets)[bucketIndex].end_iter();
-                }
-            }
-
+            index++;
+            while (index < map->slotCount() && !map->fullAt(index))
+                index++;
             return *this;
         }
     };
 
     struct const_iterator
     {
-        using LLNode = typename LL<Node>::const_iterator;
+        const HashMap *map;
+        size_t index;
 
-        const std::vector<LL<Node>> *buckets;
-        size_t bucketIndex;
-        LLNode chainIter;
-        LLNode chainEnd;
-
-        const_iterator(const std::vector<LL<Node>> *b, size_t idx)
-            : buckets(b), bucketIndex(idx)
+        const_iterator(const HashMap *m, size_t idx)
+            : map(m), index(idx)
         {
-            while (bucketIndex < buckets->size() && (*buckets)[bucketIndex].begin() == nullptr)
-            {
-                bucketIndex++;
-            }
-
-            if (bucketIndex < buckets->size())
-            {
-                chainIter = (*buckets)[bucketIndex].begin_iter();
-                chainEnd = (*buckets)[bucketIndex].end_iter();
-            }
+            while (index < map->slotCount() && !map->fullAt(index))
+                index++;
         }
 
         bool operator!=(const const_iterator &other) const
         {
-            return bucketIndex != other.bucketIndex ||
-                   chainIter != other.chainIter;
+            return index != other.index;
         }
 
         bool operator==(const const_iterator &other) const
         {
-            return bucketIndex == other.bucketIndex &&
-                   chainIter == other.chainIter;
+            return index == other.index;
         }
 
         const Node &operator*() const
         {
-            return *chainIter;
+            return map->nodeAt(index);
         }
 
         const_iterator &operator++()
         {
-            ++chainIter;
-
-            if (chainIter == chainEnd)
-            {
-                bucketIndex++;
-                while (bucketIndex < buckets->size() &&
-                       (*buckets)[bucketIndex].begin() == nullptr)
-                {
-                    bucketIndex++;
-                }
-
-                if (bucketIndex < buckets->size())
-                {
-                    chainIter = (*buckets)[bucketIndex].begin_iter();
-                    chainEnd = (*buckets)[bucketIndex].end_iter();
-                }
-            }
-
+            index++;
+            while (index < map->slotCount() && !map->fullAt(index))
+                index++;
             return *this;
         }
     };
 
     iterator begin()
     {
-        return iterator(&buckets, 0);
+        return iterator(this, 0);
     }
 
     iterator end()
     {
-        return iterator(&buckets, buckets.size());
+        return iterator(this, slotCount());
     }
 
     iterator find(const K &key)
     {
-        size_t index = hashKey(key, buckets.size());
-        auto &chain = buckets[index];
-
-        for (auto it = chain.begin_iter(); it != chain.end_iter(); ++it)
-        {
-            if ((*it).key == key)
-            {
-                iterator mapIt(&buckets, index);
-                mapIt.chainIter = it;
-                mapIt.chainEnd = chain.end_iter();
-                return mapIt;
-            }
-        }
-        return end();
+        size_t idx;
+        Table *t = locate(key, idx);
+        return t ? iterator(this, positionOf(t, idx)) : end();
     }
 
     const_iterator begin() const
     {
-        return const_iterator(&buckets, 0);
+        return const_iterator(this, 0);
     }
 
     const_iterator end() const
     {
-        return const_iterator(&buckets, buckets.size());
+        return const_iterator(this, slotCount());
     }
 
     const_iterator find(const K &key) const
     {
-        size_t index = hashKey(key, buckets.size());
-        auto &chain = buckets[index];
+        size_t idx;
+        const Table *t = locate(key, idx);
+        return t ? const_iterator(this, positionOf(t, idx)) : end();
+    }
 
-        for (auto it = chain.begin_iter(); it != chain.end_iter(); ++it)
-        {
-            if ((*it).key == key)
-            {
-                const_iterator mapIt(&buckets, index);
-                mapIt.chainIter = it;
-                mapIt.chainEnd = chain.end_iter();
-                return mapIt;
-            }
-        }
-        return end();
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    iterator find(const Q &key)
+    {
+        size_t idx;
+        Table *t = locate(key, idx);
+        return t ? iterator(this, positionOf(t, idx)) : end();
     }
-};
\ No newline at end of file
+
+    template <typename Q, typename HH = H, typename = typename HH::is_transparent>
+    const_iterator find(const Q &key) const
+    {
+        size_t idx;
+        const Table *t = locate(key, idx);
+        return t ? const_iterator(this, positionOf(t, idx)) : end();
+    }
+};
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "memory_usage.hpp"
+#include "pool_allocator.hpp"
+
 template <typename T>
 struct Node
 {
@@ -9,13 +12,14 @@ struct Node
     Node(T val) : data(val), next(nullptr) {}
 };
 
-template <typename T>
+template <typename T, template <typename> class Alloc = PoolAllocator>
 class LinkedList
 {
 private:
     Node<T> *headNode;
     Node<T> *tailNode;
     size_t count;
+    Alloc<Node<T>> alloc;
 
 public:
     LinkedList() : headNode(nullptr), tailNode(nullptr), count(0) {}
@@ -27,7 +31,7 @@ public:
 
     void append(T value)
     {
-        Node<T> *newNode = new Node<T>(value);
+        Node<T> *newNode = alloc.create(value);
 
         if (!headNode)
         {
@@ -43,7 +47,7 @@ public:
 
     void prepend(T value)
     {
-        Node<T> *newNode = new Node<T>(value);
+        Node<T> *newNode = alloc.create(value);
 
         if (!headNode)
         {
@@ -74,7 +78,7 @@ public:
             return;
         }
 
-        Node<T> *newNode = new Node<T>(value);
+        Node<T> *newNode = alloc.create(value);
         Node<T> *current = headNode;
 
         for (size_t i = 0; i < index - 1; i++)
@@ -100,7 +104,7 @@ public:
             headNode = headNode->next;
             if (!headNode)
                 tailNode = nullptr;
-            delete toDelete;
+            alloc.destroy(toDelete);
             count--;
             return true;
         }
@@ -117,7 +121,7 @@ public:
         if (!current->next)
             tailNode = current;
 
-        delete toDelete;
+        alloc.destroy(toDelete);
         count--;
         return true;
     }
@@ -133,7 +137,7 @@ public:
             headNode = headNode->next;
             if (!headNode)
                 tailNode = nullptr;
-            delete toDelete;
+            alloc.destroy(toDelete);
             count--;
             return true;
         }
@@ -147,7 +151,7 @@ public:
                 current->next = toDelete->next;
                 if (!current->next)
                     tailNode = current;
-                delete toDelete;
+                alloc.destroy(toDelete);
                 count--;
                 return true;
             }
@@ -205,7 +209,7 @@ public:
         {
             Node<T> *temp = headNode;
             headNode = headNode->next;
-            delete temp;
+            alloc.destroy(temp);
         }
         tailNode = nullptr;
         count = 0;
@@ -230,6 +234,20 @@ public:
     {
         return tailNode;
     }
+
+    // Walks every node: O(n)
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.payloadBytes = count * sizeof(T);
+        u.metadataBytes = sizeof(*this) + count * (sizeof(Node<T>) - sizeof(T));
+        u.slotsUsed = count;
+        alloc.accountMemory(u, count);
+
+        for (Node<T> *curr = headNode; curr; curr = curr->next)
+            addOwnedMemory(u, curr->data);
+        return u;
+    }
 };
 
 // Key-Value pair LinkedList for HashMap
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Memory footprint of a container, as reported by memoryUsage() on every ADT.
+// The three byte counts are disjoint and add up to total():
+//     payload   element storage (keys, values, node data, heap bytes they own)
+//     metadata  bookkeeping: the container object, control bytes, node links
+//     overhead  reserved but unused: empty/deleted slots, vector slack, free pool nodes
+// slotsUsed/slotsTotal describe the primary storage (table slots, vector
+// capacity, pooled nodes, trie child links) and give the load factor.
+struct MemoryUsage
+{
+    size_t payloadBytes = 0;
+    size_t metadataBytes = 0;
+    size_t overheadBytes = 0;
+    size_t slotsUsed = 0;
+    size_t slotsTotal = 0;
+    size_t longestProbe = 0; // hash tables: most groups scanned to find a key
+
+    size_t total() const
+    {
+        return payloadBytes + metadataBytes + overheadBytes;
+    }
+
+    double loadFactor() const
+    {
+        return slotsTotal ? (double)slotsUsed / slotsTotal : 0.0;
+    }
+
+    // Bytes owned by a sub-container (element, member); its slots are not ours
+    void addBytesOf(const MemoryUsage &other)
+    {
+        payloadBytes += other.payloadBytes;
+        metadataBytes += other.metadataBytes;
+        overheadBytes += other.overheadBytes;
+        if (other.longestProbe > longestProbe)
+            longestProbe = other.longestProbe;
+    }
+
+    // Aggregation across containers (e.g. per module)
+    MemoryUsage &operator+=(const MemoryUsage &other)
+    {
+        addBytesOf(other);
+        slotsUsed += other.slotsUsed;
+        slotsTotal += other.slotsTotal;
+        return *this;
+    }
+};
+
+// addOwnedMemory(u, v): add to u the heap memory v owns beyond sizeof(v).
+// Containers count sizeof(element) themselves and call this per element, so
+// nested ADTs (Set values of a Graph, Queue values of a chat map) are included.
+// Raw pointers are not followed; the owner of the pointee accounts for it.
+
+namespace memory_detail
+{
+    template <typename T>
+    auto addOwned(MemoryUsage &u, const T &v, int) -> decltype(v.memoryUsage(), void())
+    {
+        MemoryUsage inner = v.memoryUsage();
+        inner.metadataBytes -= sizeof(T); // the object itself is already counted by the caller
+        u.addBytesOf(inner);
+    }
+
+    template <typename T>
+    void addOwned(MemoryUsage &, const T &, long) {}
+}
+
+template <typename T>
+void addOwnedMemory(MemoryUsage &u, const T &v)
+{
+    memory_detail::addOwned(u, v, 0);
+}
+
+inline void addOwnedMemory(MemoryUsage &u, const std::string &s)
+{
+    // Short strings live inside the object itself
+    const char *self = reinterpret_cast<const char *>(&s);
+    if (s.data() >= self && s.data() < self + sizeof(s))
+        return;
+
+    u.payloadBytes += s.size() + 1;
+    u.overheadBytes += s.capacity() - s.size();
+}
+
+template <typename T>
+void addOwnedMemory(MemoryUsage &u, const std::vector<T> &v)
+{
+    u.payloadBytes += v.size() * sizeof(T);
+    u.overheadBytes += (v.capacity() - v.size()) * sizeof(T);
+    for (const T &item : v)
+        addOwnedMemory(u, item);
+}
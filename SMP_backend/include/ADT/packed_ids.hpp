@@ -0,0 +1,331 @@
+#pragma once
+
+#include "memory_usage.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define PACKED_SSSE3 1
+#endif
+
+// Immutable ascending list of 64-bit IDs, delta-encoded in blocks of up to
+// BLOCK values. Each block is
+//
+//   [first: 8 bytes][count - 1 | WIDE: 1 byte][body length: 2 bytes][body]
+//
+// and the body holds the count - 1 gaps to the previous ID. When the block
+// spans less than 2^32 (the common case) the gaps are Stream VByte: one
+// control byte per four gaps giving each one's length (1-4 bytes), then the
+// gap bytes. Decoding expands four gaps with one byte shuffle and turns them
+// into IDs with a SIMD prefix sum. Wider blocks fall back to LEB128 varints.
+// Values are only ever decoded a block at a time, on iteration or lookup.
+class PackedIDList
+{
+public:
+    using ID = unsigned long long;
+    static const size_t BLOCK = 32;
+
+private:
+    static const size_t HEADER = 11;
+    static const uint8_t WIDE = 0x80;
+
+    std::vector<uint8_t> bytes;
+    size_t count = 0;
+
+    struct ShuffleTable
+    {
+        uint8_t masks[256][16];
+        uint8_t lengths[256];
+    };
+
+    // Per control byte: where each of the four gaps' bytes land in 32-bit lanes
+    static const ShuffleTable &shuffleTable()
+    {
+        static const ShuffleTable table = []
+        {
+            ShuffleTable t;
+            for (unsigned c = 0; c < 256; c++)
+            {
+                uint8_t at = 0;
+                for (unsigned lane = 0; lane < 4; lane++)
+                {
+                    unsigned len = ((c >> (2 * lane)) & 3) + 1;
+                    for (unsigned b = 0; b < 4; b++)
+                        t.masks[c][lane * 4 + b] = b < len ? at + b : 0x80;
+                    at += len;
+                }
+                t.lengths[c] = at;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    static ID readFirst(const uint8_t *p)
+    {
+        ID v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+
+    static size_t bodyLength(const uint8_t *p)
+    {
+        return p[9] | (size_t(p[10]) << 8);
+    }
+
+    static size_t gapLength(uint32_t gap)
+    {
+        return gap < (1u << 8) ? 1 : gap < (1u << 16) ? 2
+                                 : gap < (1u << 24)   ? 3
+                                                      : 4;
+    }
+
+    void encodeBlock(const ID *ids, size_t n)
+    {
+        size_t start = bytes.size();
+        bool wide = ids[n - 1] - ids[0] > UINT32_MAX;
+
+        bytes.resize(start + HEADER);
+        std::memcpy(&bytes[start], &ids[0], 8);
+        bytes[start + 8] = uint8_t(n - 1) | (wide ? WIDE : 0);
+
+        if (wide)
+        {
+            for (size_t i = 1; i < n; i++)
+            {
+                ID gap = ids[i] - ids[i - 1];
+                while (gap >= 0x80)
+                {
+                    bytes.push_back(uint8_t(gap) | 0x80);
+                    gap >>= 7;
+                }
+                bytes.push_back(uint8_t(gap));
+            }
+        }
+        else
+        {
+            size_t gaps = n - 1;
+            size_t ctrl = bytes.size();
+            bytes.resize(ctrl + (gaps + 3) / 4, 0);
+
+            for (size_t i = 0; i < gaps; i++)
+            {
+                uint32_t gap = uint32_t(ids[i + 1] - ids[i]);
+                size_t len = gapLength(gap);
+                bytes[ctrl + i / 4] |= uint8_t((len - 1) << (2 * (i % 4)));
+                for (size_t b = 0; b < len; b++)
+                    bytes.push_back(uint8_t(gap >> (8 * b)));
+            }
+        }
+
+        size_t body = bytes.size() - start - HEADER;
+        bytes[start + 9] = uint8_t(body);
+        bytes[start + 10] = uint8_t(body >> 8);
+    }
+
+    // Decodes the block at p into out; returns how many IDs it holds
+    size_t decodeBlock(const uint8_t *p, ID *out) const
+    {
+        ID first = readFirst(p);
+        size_t n = (p[8] & ~WIDE) + 1;
+        const uint8_t *body = p + HEADER;
+        out[0] = first;
+
+        if (p[8] & WIDE)
+        {
+            ID v = first;
+            for (size_t i = 1; i < n; i++)
+            {
+                ID gap = 0;
+                unsigned shift = 0;
+                uint8_t byte;
+                do
+                {
+                    byte = *body++;
+                    gap |= ID(byte & 0x7f) << shift;
+                    shift += 7;
+                } while (byte & 0x80);
+                v += gap;
+                out[i] = v;
+            }
+            return n;
+        }
+
+        size_t gaps = n - 1;
+        const uint8_t *ctrl = body;
+        const uint8_t *data = body + (gaps + 3) / 4;
+        uint32_t offset = 0; // running distance from first; fits since the block spans < 2^32
+        size_t i = 0;
+
+#if defined(PACKED_SSSE3)
+        const ShuffleTable &table = shuffleTable();
+        const uint8_t *end = bytes.data() + bytes.size();
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i base = _mm_set1_epi64x((long long)first);
+
+        // Whole groups of four, while a 16-byte load stays inside the buffer
+        for (; i + 4 <= gaps && data + 16 <= end; i += 4)
+        {
+            uint8_t c = ctrl[i / 4];
+            __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            __m128i v = _mm_shuffle_epi8(raw, _mm_loadu_si128(reinterpret_cast<const __m128i *>(table.masks[c])));
+            data += table.lengths[c];
+
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, _mm_set1_epi32((int)offset));
+            offset = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 1 + i), _mm_add_epi64(_mm_unpacklo_epi32(v, zero), base));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 3 + i), _mm_add_epi64(_mm_unpackhi_epi32(v, zero), base));
+        }
+#endif
+
+        for (; i < gaps; i++)
+        {
+            size_t len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+            uint32_t gap = 0;
+            for (size_t b = 0; b < len; b++)
+                gap |= uint32_t(data[b]) << (8 * b);
+            data += len;
+            offset += gap;
+            out[i + 1] = first + offset;
+        }
+        return n;
+    }
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ID;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ID *;
+        using reference = ID;
+
+    private:
+        const PackedIDList *list = nullptr;
+        size_t index = 0;   // position in the whole list
+        size_t nextPos = 0; // byte offset of the next block to decode
+        size_t i = 0, n = 0;
+        ID buf[BLOCK];
+
+        void load()
+        {
+            i = 0;
+            n = list->decodeBlock(list->bytes.data() + nextPos, buf);
+            nextPos += HEADER + bodyLength(list->bytes.data() + nextPos);
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator(const PackedIDList *l, bool atEnd) : list(l)
+        {
+            if (atEnd)
+                index = l->count;
+            else if (l->count)
+                load();
+        }
+
+        ID operator*() const { return buf[i]; }
+        bool atEnd() const { return index >= list->count; }
+
+        const_iterator &operator++()
+        {
+            index++;
+            if (++i == n && index < list->count)
+                load();
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+    };
+
+    PackedIDList() = default;
+
+    // ids must be ascending and duplicate-free
+    PackedIDList(const ID *ids, size_t n) : count(n)
+    {
+        for (size_t i = 0; i < n; i += BLOCK)
+            encodeBlock(ids + i, n - i < BLOCK ? n - i : BLOCK);
+        bytes.shrink_to_fit();
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    // Skips whole blocks by their first ID, then decodes at most one
+    bool contains(ID id) const
+    {
+        const uint8_t *p = bytes.data();
+        const uint8_t *end = p + bytes.size();
+
+        while (p != end)
+        {
+            if (id < readFirst(p))
+                return false;
+
+            const uint8_t *next = p + HEADER + bodyLength(p);
+            if (next == end || id < readFirst(next))
+            {
+                ID buf[BLOCK];
+                size_t n = decodeBlock(p, buf);
+                for (size_t i = 0; i < n && buf[i] <= id; i++)
+                {
+                    if (buf[i] == id)
+                        return true;
+                }
+                return false;
+            }
+            p = next;
+        }
+        return false;
+    }
+
+    // The i-th smallest ID (i < size()); skips whole blocks, then decodes one
+    ID at(size_t i) const
+    {
+        const uint8_t *p = bytes.data();
+        for (size_t block = i / BLOCK; block > 0; block--)
+            p += HEADER + bodyLength(p);
+
+        ID buf[BLOCK];
+        decodeBlock(p, buf);
+        return buf[i % BLOCK];
+    }
+
+    const_iterator begin() const { return const_iterator(this, false); }
+    const_iterator end() const { return const_iterator(this, true); }
+
+    std::vector<ID> toVector() const
+    {
+        std::vector<ID> out(count);
+        size_t at = 0;
+        for (size_t pos = 0; pos < bytes.size(); pos += HEADER + bodyLength(&bytes[pos]))
+            at += decodeBlock(&bytes[pos], &out[at]);
+        out.resize(count);
+        return out;
+    }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this);
+        u.slotsUsed = count;
+        u.slotsTotal = count;
+        addOwnedMemory(u, bytes);
+        return u;
+    }
+};
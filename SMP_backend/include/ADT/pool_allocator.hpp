@@ -0,0 +1,170 @@
+#pragma once
+
+#include "memory_usage.hpp"
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Node allocation policies for the linked ADTs (LinkedList, Queue, ...).
+// A policy is any class template with
+//     T *create(args...)   construct a node
+//     void destroy(T *)    destroy and release it
+//     void accountMemory(MemoryUsage &, size_t liveNodes)
+//                          add allocator overhead and reserved node slots
+
+// Plain new/delete per node
+template <typename T>
+struct HeapAllocator
+{
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *node)
+    {
+        delete node;
+    }
+
+    // Estimate: one pointer-sized malloc header per node
+    void accountMemory(MemoryUsage &u, size_t liveNodes) const
+    {
+        u.overheadBytes += liveNodes * sizeof(void *);
+        u.slotsTotal += liveNodes;
+    }
+};
+
+// Slab pool: nodes are carved out of slabs that double in size (FIRST_SLAB up
+// to MAX_SLAB nodes), and destroyed nodes go on an intrusive free list to be
+// reused by the next create(). Node churn (enqueue/dequeue, follow/unfollow)
+// then never reaches the global allocator, and nodes of one container stay
+// close together in memory. Slabs are returned only when the pool dies, so the
+// owning container must destroy all its nodes first.
+template <typename T>
+class PoolAllocator
+{
+private:
+    static const size_t FIRST_SLAB = 4;
+    static const size_t MAX_SLAB = 256;
+
+    union Slot
+    {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<Slot *> slabs;
+    Slot *freeList;
+    Slot *bump; // next never-used slot of the newest slab
+    Slot *bumpEnd;
+    size_t nextSlabSize;
+    size_t reservedSlots; // slots across all slabs
+
+    void grow()
+    {
+        Slot *slab = static_cast<Slot *>(::operator new(sizeof(Slot) * nextSlabSize));
+        slabs.push_back(slab);
+        bump = slab;
+        bumpEnd = slab + nextSlabSize;
+        reservedSlots += nextSlabSize;
+        if (nextSlabSize < MAX_SLAB)
+            nextSlabSize *= 2;
+    }
+
+    void release()
+    {
+        for (Slot *slab : slabs)
+            ::operator delete(slab);
+        slabs.clear();
+        freeList = bump = bumpEnd = nullptr;
+        nextSlabSize = FIRST_SLAB;
+        reservedSlots = 0;
+    }
+
+public:
+    PoolAllocator()
+        : freeList(nullptr), bump(nullptr), bumpEnd(nullptr), nextSlabSize(FIRST_SLAB), reservedSlots(0) {}
+
+    ~PoolAllocator() { release(); }
+
+    // Live nodes belong to their pool, so a pool can move with its container but not be copied
+    PoolAllocator(const PoolAllocator &) = delete;
+    PoolAllocator &operator=(const PoolAllocator &) = delete;
+
+    PoolAllocator(PoolAllocator &&other) noexcept
+        : slabs(std::move(other.slabs)), freeList(other.freeList), bump(other.bump),
+          bumpEnd(other.bumpEnd), nextSlabSize(other.nextSlabSize), reservedSlots(other.reservedSlots)
+    {
+        other.slabs.clear();
+        other.freeList = other.bump = other.bumpEnd = nullptr;
+        other.nextSlabSize = FIRST_SLAB;
+        other.reservedSlots = 0;
+    }
+
+    PoolAllocator &operator=(PoolAllocator &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            slabs = std::move(other.slabs);
+            freeList = other.freeList;
+            bump = other.bump;
+            bumpEnd = other.bumpEnd;
+            nextSlabSize = other.nextSlabSize;
+            reservedSlots = other.reservedSlots;
+
+            other.slabs.clear();
+            other.freeList = other.bump = other.bumpEnd = nullptr;
+            other.nextSlabSize = FIRST_SLAB;
+            other.reservedSlots = 0;
+        }
+        return *this;
+    }
+
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        Slot *slot;
+        if (freeList)
+        {
+            slot = freeList;
+            freeList = freeList->next;
+        }
+        else
+        {
+            if (bump == bumpEnd)
+                grow();
+            slot = bump++;
+        }
+
+        try
+        {
+            return new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            slot->next = freeList;
+            freeList = slot;
+            throw;
+        }
+    }
+
+    void destroy(T *node)
+    {
+        node->~T();
+        Slot *slot = reinterpret_cast<Slot *>(node);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    // Free and never-used slots, slot padding and the slab list are overhead
+    void accountMemory(MemoryUsage &u, size_t liveNodes) const
+    {
+        u.overheadBytes += (reservedSlots - liveNodes) * sizeof(Slot) +
+                           liveNodes * (sizeof(Slot) - sizeof(T)) +
+                           slabs.capacity() * sizeof(Slot *);
+        u.slotsTotal += reservedSlots;
+    }
+};
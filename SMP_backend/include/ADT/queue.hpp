@@ -1,6 +1,9 @@
 #pragma once
 
+#include "memory_usage.hpp"
+#include "pool_allocator.hpp"
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 template <typename T>
@@ -11,15 +14,17 @@ struct QueueNode
     QueueNode<T> *prev;
 
     QueueNode(const T &val) : data(val), next(nullptr), prev(nullptr) {}
+    QueueNode(T &&val) : data(std::move(val)), next(nullptr), prev(nullptr) {}
 };
 
-template <typename T>
+template <typename T, template <typename> class Alloc = PoolAllocator>
 class Queue
 {
 private:
     QueueNode<T> *m_front;
     QueueNode<T> *m_back;
     size_t m_size;
+    Alloc<QueueNode<T>> alloc;
 
     void clear()
     {
@@ -28,7 +33,7 @@ private:
         {
             QueueNode<T> *temp = curr;
             curr = curr->next;
-            delete temp;
+            alloc.destroy(temp);
         }
         m_front = m_back = nullptr;
         m_size = 0;
@@ -38,7 +43,7 @@ public:
     Queue() : m_front(nullptr), m_back(nullptr), m_size(0) {}
     ~Queue() { clear(); }
 
-    Queue(const Queue<T> &other) : m_front(nullptr), m_back(nullptr), m_size(0)
+    Queue(const Queue &other) : m_front(nullptr), m_back(nullptr), m_size(0)
     {
         QueueNode<T> *curr = other.m_front;
         while (curr)
@@ -48,7 +53,17 @@ public:
         }
     }
 
-    Queue<T> operator=(const Queue &other)
+    // Moves steal the node chain (and the pool it lives in), so maps of queues
+    // resize without copying messages
+    Queue(Queue &&other) noexcept
+        : m_front(other.m_front), m_back(other.m_back), m_size(other.m_size),
+          alloc(std::move(other.alloc))
+    {
+        other.m_front = other.m_back = nullptr;
+        other.m_size = 0;
+    }
+
+    Queue &operator=(const Queue &other)
     {
         if (this != &other)
         {
@@ -63,12 +78,32 @@ public:
         return *this;
     }
 
+    Queue &operator=(Queue &&other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            alloc = std::move(other.alloc);
+            m_front = other.m_front;
+            m_back = other.m_back;
+            m_size = other.m_size;
+            other.m_front = other.m_back = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
     bool isEmpty() const { return m_size == 0; }
     size_t size() const { return m_size; }
 
     void enqueue(const T &item)
     {
-        QueueNode<T> *newNode = new QueueNode<T>(item);
+        enqueue(T(item));
+    }
+
+    void enqueue(T &&item)
+    {
+        QueueNode<T> *newNode = alloc.create(std::move(item));
         if (isEmpty())
         {
             m_front = m_back = newNode;
@@ -98,7 +133,7 @@ public:
         {
             m_back = nullptr;
         }
-        delete temp;
+        alloc.destroy(temp);
         m_size--;
     }
 
@@ -163,4 +198,18 @@ public:
         }
         return nullptr;
     }
+
+    // Walks every node: O(n)
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.payloadBytes = m_size * sizeof(T);
+        u.metadataBytes = sizeof(*this) + m_size * (sizeof(QueueNode<T>) - sizeof(T));
+        u.slotsUsed = m_size;
+        alloc.accountMemory(u, m_size);
+
+        for (QueueNode<T> *curr = m_front; curr; curr = curr->next)
+            addOwnedMemory(u, curr->data);
+        return u;
+    }
 };
@@ -0,0 +1,725 @@
+#pragma once
+
+#include "memory_usage.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+inline unsigned popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline unsigned countTrailingZeros64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Compressed set of 64-bit IDs (roaring bitmap). IDs are split into a high
+// part (id >> 16) naming a container and a 16-bit low part stored in it, in
+// whichever of three forms is smallest for that chunk of the ID space:
+//     ARRAY   sorted lows, 2 bytes each        (up to 4096 members)
+//     BITMAP  65536 bits in 1024 words, 8 KB   (dense chunks)
+//     RUN     (start, length - 1) pairs        (long consecutive ranges)
+// Sequentially assigned IDs (users, posts) land in few, dense containers, so
+// large sets cost a few bits per member instead of a hash slot, and
+// intersection/union of bitmap chunks is word-wide AND/OR plus popcount.
+//
+// Iteration is in ascending ID order. ARRAY and BITMAP convert into each other
+// as they cross 4096 members; RUN form is only chosen by runOptimize().
+class RoaringSet
+{
+private:
+    enum Kind : uint8_t
+    {
+        ARRAY,
+        BITMAP,
+        RUN
+    };
+
+    static const uint32_t ARRAY_MAX = 4096; // 4096 lows take 8 KB, same as a bitmap
+    static const size_t WORDS = 1024;
+
+    struct Container
+    {
+        uint64_t high = 0;
+        Kind kind = ARRAY;
+        uint32_t card = 0;
+        std::vector<uint16_t> values; // ARRAY: sorted lows; RUN: start, length - 1, ...
+        std::vector<uint64_t> words;  // BITMAP
+    };
+
+    std::vector<Container> containers; // ascending by high, none empty
+    size_t total = 0;
+
+    static uint64_t highOf(unsigned long long id) { return id >> 16; }
+    static uint16_t lowOf(unsigned long long id) { return (uint16_t)(id & 0xFFFF); }
+
+    // Index of the container for high, or where it would be inserted
+    size_t findContainer(uint64_t high) const
+    {
+        size_t lo = 0, hi = containers.size();
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (containers[mid].high < high)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // ---- runs ----
+
+    static size_t runCount(const Container &c) { return c.values.size() / 2; }
+    static uint32_t runStart(const Container &c, size_t r) { return c.values[2 * r]; }
+    static uint32_t runEnd(const Container &c, size_t r) { return (uint32_t)c.values[2 * r] + c.values[2 * r + 1]; }
+
+    // First run starting after low
+    static size_t runAfter(const Container &c, uint16_t low)
+    {
+        size_t lo = 0, hi = runCount(c);
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (runStart(c, mid) <= low)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // ---- single container ----
+
+    template <typename Fn>
+    static void forEachLow(const Container &c, Fn &&fn)
+    {
+        if (c.kind == ARRAY)
+        {
+            for (uint16_t v : c.values)
+                fn(v);
+        }
+        else if (c.kind == BITMAP)
+        {
+            for (size_t w = 0; w < WORDS; w++)
+            {
+                for (uint64_t bits = c.words[w]; bits; bits &= bits - 1)
+                    fn((uint16_t)(w * 64 + countTrailingZeros64(bits)));
+            }
+        }
+        else
+        {
+            for (size_t r = 0; r < runCount(c); r++)
+            {
+                for (uint32_t v = runStart(c, r); v <= runEnd(c, r); v++)
+                    fn((uint16_t)v);
+            }
+        }
+    }
+
+    static void fillWords(const Container &c, uint64_t *words)
+    {
+        if (c.kind == BITMAP)
+        {
+            std::copy(c.words.begin(), c.words.end(), words);
+            return;
+        }
+
+        std::fill(words, words + WORDS, 0);
+        forEachLow(c, [words](uint16_t v)
+                   { words[v >> 6] |= 1ULL << (v & 63); });
+    }
+
+    static bool has(const Container &c, uint16_t low)
+    {
+        if (c.kind == ARRAY)
+            return std::binary_search(c.values.begin(), c.values.end(), low);
+        if (c.kind == BITMAP)
+            return (c.words[low >> 6] >> (low & 63)) & 1;
+
+        size_t r = runAfter(c, low);
+        return r > 0 && low <= runEnd(c, r - 1);
+    }
+
+    static void toBitmap(Container &c)
+    {
+        std::vector<uint64_t> words(WORDS);
+        fillWords(c, words.data());
+        c.words.swap(words);
+        std::vector<uint16_t>().swap(c.values);
+        c.kind = BITMAP;
+    }
+
+    static void toArray(Container &c)
+    {
+        std::vector<uint16_t> values;
+        values.reserve(c.card);
+        forEachLow(c, [&values](uint16_t v)
+                   { values.push_back(v); });
+        c.values.swap(values);
+        std::vector<uint64_t>().swap(c.words);
+        c.kind = ARRAY;
+    }
+
+    // Array or bitmap, whichever suits the cardinality
+    static void toPlain(Container &c)
+    {
+        if (c.card <= ARRAY_MAX)
+            toArray(c);
+        else
+            toBitmap(c);
+    }
+
+    // A run container that fragmented past the size of the plain form gives up
+    static void checkRunSize(Container &c)
+    {
+        size_t runBytes = c.values.size() * 2;
+        size_t plainBytes = c.card <= ARRAY_MAX ? c.card * 2 : WORDS * 8;
+        if (runBytes > plainBytes)
+            toPlain(c);
+    }
+
+    static bool add(Container &c, uint16_t low)
+    {
+        if (c.kind == ARRAY)
+        {
+            auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+            if (it != c.values.end() && *it == low)
+                return false;
+
+            c.values.insert(it, low);
+            if (++c.card > ARRAY_MAX)
+                toBitmap(c);
+            return true;
+        }
+
+        if (c.kind == BITMAP)
+        {
+            uint64_t &w = c.words[low >> 6];
+            uint64_t bit = 1ULL << (low & 63);
+            if (w & bit)
+                return false;
+
+            w |= bit;
+            c.card++;
+            return true;
+        }
+
+        // RUN: extend a neighbouring run, bridge two, or start a new one
+        size_t next = runAfter(c, low);
+        bool joinsPrev = false;
+        if (next > 0)
+        {
+            uint32_t prevEnd = runEnd(c, next - 1);
+            if (low <= prevEnd)
+                return false;
+            joinsPrev = prevEnd + 1 == low;
+        }
+        bool joinsNext = next < runCount(c) && runStart(c, next) == (uint32_t)low + 1;
+
+        if (joinsPrev && joinsNext)
+        {
+            c.values[2 * (next - 1) + 1] = (uint16_t)(runEnd(c, next) - runStart(c, next - 1));
+            c.values.erase(c.values.begin() + 2 * next, c.values.begin() + 2 * next + 2);
+        }
+        else if (joinsPrev)
+            c.values[2 * (next - 1) + 1]++;
+        else if (joinsNext)
+        {
+            c.values[2 * next] = low;
+            c.values[2 * next + 1]++;
+        }
+        else
+        {
+            uint16_t run[2] = {low, 0};
+            c.values.insert(c.values.begin() + 2 * next, run, run + 2);
+        }
+
+        c.card++;
+        checkRunSize(c);
+        return true;
+    }
+
+    static bool remove(Container &c, uint16_t low)
+    {
+        if (c.kind == ARRAY)
+        {
+            auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+            if (it == c.values.end() || *it != low)
+                return false;
+
+            c.values.erase(it);
+            c.card--;
+            return true;
+        }
+
+        if (c.kind == BITMAP)
+        {
+            uint64_t &w = c.words[low >> 6];
+            uint64_t bit = 1ULL << (low & 63);
+            if (!(w & bit))
+                return false;
+
+            w &= ~bit;
+            if (--c.card <= ARRAY_MAX)
+                toArray(c);
+            return true;
+        }
+
+        // RUN: shrink, drop or split the run holding low
+        size_t r = runAfter(c, low);
+        if (r == 0 || low > runEnd(c, r - 1))
+            return false;
+        r--;
+
+        uint32_t start = runStart(c, r), end = runEnd(c, r);
+        if (start == end)
+            c.values.erase(c.values.begin() + 2 * r, c.values.begin() + 2 * r + 2);
+        else if (low == start)
+        {
+            c.values[2 * r]++;
+            c.values[2 * r + 1]--;
+        }
+        else if (low == end)
+            c.values[2 * r + 1]--;
+        else
+        {
+            c.values[2 * r + 1] = (uint16_t)(low - 1 - start);
+            uint16_t tail[2] = {(uint16_t)(low + 1), (uint16_t)(end - low - 1)};
+            c.values.insert(c.values.begin() + 2 * r + 2, tail, tail + 2);
+        }
+
+        c.card--;
+        checkRunSize(c);
+        return true;
+    }
+
+    // Members of both containers (plain form; empty card if none)
+    static Container intersect(const Container &a, const Container &b)
+    {
+        Container out;
+        out.high = a.high;
+
+        if (a.kind == ARRAY || b.kind == ARRAY)
+        {
+            const Container &arr = a.kind == ARRAY ? a : b;
+            const Container &other = a.kind == ARRAY ? b : a;
+            for (uint16_t v : arr.values)
+            {
+                if (has(other, v))
+                    out.values.push_back(v);
+            }
+            out.card = (uint32_t)out.values.size();
+            return out;
+        }
+
+        out.kind = BITMAP;
+        out.words.resize(WORDS);
+        fillWords(a, out.words.data());
+        uint64_t other[WORDS];
+        fillWords(b, other);
+        for (size_t w = 0; w < WORDS; w++)
+        {
+            out.words[w] &= other[w];
+            out.card += popcount64(out.words[w]);
+        }
+        if (out.card <= ARRAY_MAX)
+            toArray(out);
+        return out;
+    }
+
+    static uint32_t intersectionCount(const Container &a, const Container &b)
+    {
+        if (a.kind == BITMAP && b.kind == BITMAP)
+        {
+            uint32_t n = 0;
+            for (size_t w = 0; w < WORDS; w++)
+                n += popcount64(a.words[w] & b.words[w]);
+            return n;
+        }
+
+        if (a.kind == ARRAY || b.kind == ARRAY)
+        {
+            const Container &arr = a.kind == ARRAY ? a : b;
+            const Container &other = a.kind == ARRAY ? b : a;
+            uint32_t n = 0;
+            for (uint16_t v : arr.values)
+                n += has(other, v);
+            return n;
+        }
+
+        return intersect(a, b).card;
+    }
+
+    static Container unite(const Container &a, const Container &b)
+    {
+        Container out;
+        out.high = a.high;
+
+        if (a.kind == ARRAY && b.kind == ARRAY && a.card + b.card <= ARRAY_MAX)
+        {
+            std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                           std::back_inserter(out.values));
+            out.card = (uint32_t)out.values.size();
+            return out;
+        }
+
+        out.kind = BITMAP;
+        out.words.resize(WORDS);
+        fillWords(a, out.words.data());
+        uint64_t other[WORDS];
+        fillWords(b, other);
+        for (size_t w = 0; w < WORDS; w++)
+        {
+            out.words[w] |= other[w];
+            out.card += popcount64(out.words[w]);
+        }
+        if (out.card <= ARRAY_MAX)
+            toArray(out);
+        return out;
+    }
+
+    // Re-encode c in its smallest form, runs included
+    static void optimize(Container &c)
+    {
+        size_t runs = 0;
+        int32_t prev = -2;
+        forEachLow(c, [&runs, &prev](uint16_t v)
+                   {
+                       if ((int32_t)v != prev + 1)
+                           runs++;
+                       prev = v; });
+
+        size_t plainBytes = c.card <= ARRAY_MAX ? c.card * 2 : WORDS * 8;
+        if (runs * 4 >= plainBytes)
+        {
+            if (c.kind == RUN)
+                toPlain(c);
+            return;
+        }
+        if (c.kind == RUN)
+            return;
+
+        std::vector<uint16_t> values;
+        values.reserve(runs * 2);
+        forEachLow(c, [&values](uint16_t v)
+                   {
+                       if (!values.empty() && (uint32_t)values[values.size() - 2] + values.back() + 1 == v)
+                           values.back()++;
+                       else
+                       {
+                           values.push_back(v);
+                           values.push_back(0);
+                       } });
+        c.values.swap(values);
+        std::vector<uint64_t>().swap(c.words);
+        c.kind = RUN;
+    }
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = unsigned long long;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const unsigned long long *;
+        using reference = unsigned long long;
+
+    private:
+        friend class RoaringSet;
+
+        const RoaringSet *set = nullptr;
+        size_t ci = 0;    // container
+        uint32_t pos = 0; // ARRAY index, BITMAP bit, RUN run
+        uint32_t off = 0; // offset inside a run
+
+        const Container &container() const { return set->containers[ci]; }
+
+        // From bit pos onward, the next set bit of a bitmap container (65536 if none)
+        uint32_t nextBit(uint32_t from) const
+        {
+            const Container &c = container();
+            for (size_t w = from >> 6; w < WORDS; w++)
+            {
+                uint64_t bits = c.words[w];
+                if (w == (from >> 6))
+                    bits &= ~0ULL << (from & 63);
+                if (bits)
+                    return (uint32_t)(w * 64 + countTrailingZeros64(bits));
+            }
+            return 1u << 16;
+        }
+
+        // Start of container ci (which is non-empty) or the end position
+        void enterContainer()
+        {
+            pos = off = 0;
+            if (ci < set->containers.size() && container().kind == BITMAP)
+                pos = nextBit(0);
+        }
+
+        const_iterator(const RoaringSet *s, size_t c) : set(s), ci(c) { enterContainer(); }
+
+    public:
+        const_iterator() = default;
+
+        unsigned long long operator*() const
+        {
+            const Container &c = container();
+            uint32_t low = c.kind == ARRAY ? c.values[pos] : c.kind == BITMAP ? pos
+                                                                              : runStart(c, pos) + off;
+            return (c.high << 16) | low;
+        }
+
+        const_iterator &operator++()
+        {
+            const Container &c = container();
+            bool done;
+            if (c.kind == ARRAY)
+                done = ++pos >= c.card;
+            else if (c.kind == BITMAP)
+                done = (pos = nextBit(pos + 1)) >= (1u << 16);
+            else
+            {
+                if (runStart(c, pos) + off < runEnd(c, pos))
+                    off++;
+                else
+                {
+                    pos++;
+                    off = 0;
+                }
+                done = pos >= runCount(c);
+            }
+
+            if (done)
+            {
+                ci++;
+                enterContainer();
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return ci == other.ci && pos == other.pos && off == other.off;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    RoaringSet() = default;
+
+    bool insert(unsigned long long id)
+    {
+        uint64_t high = highOf(id);
+        size_t i = findContainer(high);
+        if (i == containers.size() || containers[i].high != high)
+        {
+            Container c;
+            c.high = high;
+            containers.insert(containers.begin() + i, std::move(c));
+        }
+
+        if (!add(containers[i], lowOf(id)))
+            return false;
+
+        total++;
+        return true;
+    }
+
+    bool erase(unsigned long long id)
+    {
+        size_t i = findContainer(highOf(id));
+        if (i == containers.size() || containers[i].high != highOf(id))
+            return false;
+
+        if (!remove(containers[i], lowOf(id)))
+            return false;
+
+        if (containers[i].card == 0)
+            containers.erase(containers.begin() + i);
+        total--;
+        return true;
+    }
+
+    bool contains(unsigned long long id) const
+    {
+        size_t i = findContainer(highOf(id));
+        return i < containers.size() && containers[i].high == highOf(id) &&
+               has(containers[i], lowOf(id));
+    }
+
+    size_t size() const
+    {
+        return total;
+    }
+
+    bool empty() const
+    {
+        return total == 0;
+    }
+
+    // The i-th smallest ID (i < size()); skips whole containers by card
+    unsigned long long at(size_t i) const
+    {
+        size_t k = 0;
+        while (i >= containers[k].card)
+            i -= containers[k++].card;
+
+        const Container &c = containers[k];
+        uint64_t base = c.high << 16;
+        if (c.kind == ARRAY)
+            return base | c.values[i];
+
+        if (c.kind == BITMAP)
+        {
+            size_t w = 0;
+            while (i >= popcount64(c.words[w]))
+                i -= popcount64(c.words[w++]);
+            uint64_t bits = c.words[w];
+            for (; i > 0; i--)
+                bits &= bits - 1;
+            return base | (w * 64 + countTrailingZeros64(bits));
+        }
+
+        size_t r = 0;
+        while (i > runEnd(c, r) - runStart(c, r))
+            i -= runEnd(c, r) - runStart(c, r++) + 1;
+        return base | (runStart(c, r) + i);
+    }
+
+    void clear()
+    {
+        containers.clear();
+        total = 0;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, containers.size()); }
+
+    std::vector<unsigned long long> toVector() const
+    {
+        std::vector<unsigned long long> out;
+        out.reserve(total);
+        for (const Container &c : containers)
+        {
+            uint64_t base = c.high << 16;
+            forEachLow(c, [&out, base](uint16_t v)
+                       { out.push_back(base | v); });
+        }
+        return out;
+    }
+
+    size_t intersectionSize(const RoaringSet &other) const
+    {
+        size_t n = 0;
+        size_t i = 0, j = 0;
+        while (i < containers.size() && j < other.containers.size())
+        {
+            uint64_t a = containers[i].high, b = other.containers[j].high;
+            if (a < b)
+                i++;
+            else if (b < a)
+                j++;
+            else
+                n += intersectionCount(containers[i++], other.containers[j++]);
+        }
+        return n;
+    }
+
+    size_t unionSize(const RoaringSet &other) const
+    {
+        return total + other.total - intersectionSize(other);
+    }
+
+    RoaringSet operator&(const RoaringSet &other) const
+    {
+        RoaringSet out;
+        size_t i = 0, j = 0;
+        while (i < containers.size() && j < other.containers.size())
+        {
+            uint64_t a = containers[i].high, b = other.containers[j].high;
+            if (a < b)
+                i++;
+            else if (b < a)
+                j++;
+            else
+            {
+                Container c = intersect(containers[i++], other.containers[j++]);
+                if (c.card)
+                {
+                    out.total += c.card;
+                    out.containers.push_back(std::move(c));
+                }
+            }
+        }
+        return out;
+    }
+
+    RoaringSet operator|(const RoaringSet &other) const
+    {
+        RoaringSet out;
+        size_t i = 0, j = 0;
+        while (i < containers.size() || j < other.containers.size())
+        {
+            if (j == other.containers.size() ||
+                (i < containers.size() && containers[i].high < other.containers[j].high))
+                out.containers.push_back(containers[i++]);
+            else if (i == containers.size() || other.containers[j].high < containers[i].high)
+                out.containers.push_back(other.containers[j++]);
+            else
+                out.containers.push_back(unite(containers[i++], other.containers[j++]));
+
+            out.total += out.containers.back().card;
+        }
+        return out;
+    }
+
+    // Switch long consecutive ranges to RUN form (and back where runs no longer pay)
+    void runOptimize()
+    {
+        for (Container &c : containers)
+            optimize(c);
+    }
+
+    // Slots are the ID space covered by containers, so load is density
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this) + containers.size() * sizeof(Container);
+        u.overheadBytes = (containers.capacity() - containers.size()) * sizeof(Container);
+        u.slotsUsed = total;
+        u.slotsTotal = containers.size() << 16;
+
+        for (const Container &c : containers)
+        {
+            addOwnedMemory(u, c.values);
+            addOwnedMemory(u, c.words);
+        }
+        return u;
+    }
+};
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "hash_map.hpp"
+#include <vector>
 
-template <typename Key>
+// Members live in a dense vector, so iterating (data(), begin/end) is a
+// linear scan; the hash map only indexes each member's position in it.
+// erase moves the last member into the hole, so order is insertion order
+// only until the first erase.
+template <typename Key, typename H = Hash<Key>>
 class Set
 {
 private:
-    HashMap<Key, bool> map;
+    HashMap<Key, size_t, H> index; // member -> position in elements
     std::vector<Key> elements;
 
 public:
@@ -14,42 +19,90 @@ public:
 
     bool insert(const Key &key)
     {
-        if (map.contains(key))
-        {
+        if (!index.try_emplace(key, elements.size()).second)
             return false;
-        }
-        map.insert(key, true);
+
+        elements.push_back(key);
+        return true;
+    }
+
+    bool insert(Key &&key)
+    {
+        if (!index.try_emplace(key, elements.size()).second)
+            return false;
+
+        elements.push_back(std::move(key));
         return true;
     }
 
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        return insert(Key(std::forward<Args>(args)...));
+    }
+
     bool erase(const Key &key)
     {
-        return map.remove(key);
+        const size_t *pos = index.get(key);
+        if (!pos)
+            return false;
+
+        // Unindex first: key may refer into elements
+        size_t hole = *pos;
+        index.remove(key);
+
+        // Swap-and-pop: the last member takes the erased one's place
+        if (hole != elements.size() - 1)
+        {
+            elements[hole] = std::move(elements.back());
+            *index.get(elements[hole]) = hole;
+        }
+        elements.pop_back();
+        return true;
     }
 
     bool contains(const Key &key) const
     {
-        return map.contains(key);
+        return index.contains(key);
     }
 
     size_t size() const
     {
-        return map.size();
+        return elements.size();
+    }
+
+    bool empty() const
+    {
+        return elements.empty();
     }
 
     void clear()
     {
-        map.clear();
+        index.clear();
+        elements.clear();
     }
 
+    void reserve(size_t n)
+    {
+        index.reserve(n);
+        elements.reserve(n);
+    }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u = index.memoryUsage();
+        u.metadataBytes += sizeof(*this) - sizeof(index);
+        addOwnedMemory(u, elements);
+        return u;
+    }
+
+    // Members, contiguous
     const std::vector<Key> &data() const
     {
         return elements;
     }
 
-    auto begin() { return map.begin(); }
-    auto end() { return map.end(); }
-
-    auto begin() const { return map.begin(); }
-    auto end() const { return map.end(); }
-};
\ No newline at end of file
+    // Read-only: changing a member in place would desync the index
+    typename std::vector<Key>::const_iterator begin() const { return elements.begin(); }
+    typename std::vector<Key>::const_iterator end() const { return elements.end(); }
+};
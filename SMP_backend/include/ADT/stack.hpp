@@ -1,4 +1,5 @@
 #pragma once
+#include "memory_usage.hpp"
 #include <vector>
 
 template <typename T>
@@ -28,4 +29,14 @@ public:
         std::vector<T> reversed(data.rbegin(), data.rend());
         return reversed;
     }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this);
+        u.slotsUsed = data.size();
+        u.slotsTotal = data.capacity();
+        addOwnedMemory(u, data);
+        return u;
+    }
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "memory_usage.hpp"
 #include <vector>
 #include <string>
 
@@ -54,6 +55,22 @@ private:
             collect(node->children[i], result);
     }
 
+    void accountNode(const TrieNode<T> *node, MemoryUsage &u) const
+    {
+        u.metadataBytes += sizeof(TrieNode<T>);
+        u.slotsTotal += 26;
+        addOwnedMemory(u, node->values);
+
+        for (int i = 0; i < 26; i++)
+        {
+            if (node->children[i])
+            {
+                u.slotsUsed++;
+                accountNode(node->children[i], u);
+            }
+        }
+    }
+
 public:
     Trie() : root(new TrieNode<T>()) {}
 
@@ -104,4 +121,14 @@ public:
         collect(current, result);
         return result;
     }
+
+    // Slots are child links, so the load factor shows how sparse the nodes are.
+    // Walks the whole trie.
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage u;
+        u.metadataBytes = sizeof(*this);
+        accountNode(root, u);
+        return u;
+    }
 };
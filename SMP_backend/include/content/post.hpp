@@ -6,6 +6,7 @@
 #include <fstream>
 #include "nlohmann/json.hpp"
 #include "ADT/hash_map.hpp"
+#include "ADT/pool_allocator.hpp"
 
 typedef unsigned long long ull;
 using json = nlohmann::json;
@@ -38,6 +39,8 @@ public:
     static Post fromJSON(const json &j);
 
     void display() const;
+
+    MemoryUsage memoryUsage() const;
 };
 
 // Linked List Node for Posts
@@ -55,6 +58,7 @@ class PostList
 private:
     PostNode *head;
     size_t count;
+    PoolAllocator<PostNode> nodePool; // recycles nodes as posts come and go
 
 public:
     PostList();
@@ -67,6 +71,8 @@ public:
     size_t size() const;
     void clear();
 
+    MemoryUsage memoryUsage() const;
+
     // For serialization
     PostNode *getHead() const { return head; }
 };
@@ -98,6 +104,8 @@ public:
 
     // View Posts
     std::vector<Post *> getPostsByUser(ull userID) const; // Sorted newest first
+    // One newest-first list per user (empty if none), looked up in one batch
+    std::vector<std::vector<Post *>> getPostsByUsers(const std::vector<ull> &userIDs) const;
     std::vector<Post *> getAllPosts() const;
 
     // Search Within Posts (using KMP algorithm)
@@ -111,4 +119,7 @@ public:
     // Utility
     void displayAll() const;
     bool canEdit(ull postID) const; // Check if post is within edit window
+
+    // Indexes, post lists and the Post objects themselves
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
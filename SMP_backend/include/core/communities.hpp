@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ADT/graph.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct LabelPropagationOptions
+{
+    size_t maxIterations = 20;
+    // Stop once a pass relabels less than this fraction of users
+    double tolerance = 0.001;
+};
+
+// Community partition of the follows graph by label propagation, with
+// follows treated as undirected (a mutual follow counts twice). Every user
+// starts in their own community; each pass moves every user to the label most
+// common among their neighbours, keeping their own on a tie. Passes visit
+// users in a fixed shuffled order, split across the shared thread pool;
+// labels are updated in place, so a pass already sees its own earlier moves.
+//
+// Communities are renumbered 0..count-1 afterwards, and their members are
+// stored contiguously, which doubles as a placement order for co-locating
+// each community's data.
+class Communities
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+private:
+    std::shared_ptr<const CSRGraph::NodeIndex> index; // numbering of the graph partitioned
+    std::vector<uint32_t> community;                  // [dense ID]
+    std::vector<uint32_t> offsets;                    // community c's members are members[offsets[c], offsets[c + 1])
+    std::vector<CSRGraph::DenseID> members;
+    size_t passes = 0;
+
+public:
+    Communities(std::shared_ptr<const CSRGraph> graph, const LabelPropagationOptions &options = {});
+
+    // NONE for users not in the snapshot
+    uint32_t communityOf(NodeID user) const;
+    bool sameCommunity(NodeID a, NodeID b) const;
+
+    size_t communityCount() const;
+    size_t communitySize(uint32_t c) const;
+    // Ascending IDs
+    std::vector<NodeID> communityMembers(uint32_t c) const;
+
+    size_t passCount() const;
+
+    // Shared with the snapshot partitioned while that is still current
+    std::shared_ptr<const CSRGraph::NodeIndex> nodeIndex() const;
+
+    // Partition arrays only; the node index is counted by RelationshipGraph
+    MemoryUsage memoryUsage() const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ADT/graph.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Hop count between two users, -1 when no path exists. When exact is false
+// the distance is the shortest known route through a landmark: an upper
+// bound, unless follows were removed since the oracle was built.
+struct DistanceEstimate
+{
+    int distance;
+    bool exact;
+};
+
+// Landmark distance oracle over the follows graph. K high-degree users are
+// landmarks; for each, BFS distances to and from every user are kept as one
+// byte each, node-major so a query reads 2K bytes per endpoint. By the
+// triangle inequality these bound any distance from above (via a landmark)
+// and below (differences of landmark distances); when the bounds meet the
+// answer is exact.
+//
+// New follows are folded in by relaxing the affected distances. Unfollows
+// and new users are only counted: distances can grow after a removal and
+// paths through new users are not tracked, so answers stop claiming
+// exactness until the oracle is rebuilt.
+class DistanceOracle
+{
+private:
+    static constexpr uint8_t UNREACHED = 255;
+    static constexpr uint8_t MAX_HOPS = 254; // deeper nodes are left UNREACHED
+
+    std::shared_ptr<const CSRGraph::NodeIndex> index; // numbering of the graph built on
+    std::vector<CSRGraph::DenseID> landmarks;
+    std::vector<uint8_t> fromLandmark; // [node * K + k]: hops landmark k -> node
+    std::vector<uint8_t> toLandmark;   // [node * K + k]: hops node -> landmark k
+    std::vector<char> fromComplete;    // landmark k's BFS never hit MAX_HOPS
+    std::vector<char> toComplete;
+    size_t missedChanges = 0;          // unfollows and new users since the build
+    bool nodesAdded = false;
+
+    void bfsFrom(const CSRGraph &csr, size_t k, bool forward);
+    void relax(const Graph &g, size_t k, NodeID start, uint8_t dist, bool forward);
+
+public:
+    DistanceOracle(std::shared_ptr<const CSRGraph> graph, size_t landmarkCount);
+
+    // O(K) bounds lookup
+    DistanceEstimate estimate(NodeID from, NodeID to) const;
+
+    // g is the live graph, already holding the new edge
+    void edgeAdded(const Graph &g, NodeID from, NodeID to);
+    void edgeRemoved();
+    void nodeAdded();
+    // Some changes made since the snapshot it was built on were never passed
+    // in; they may have added paths, so answers are treated as after nodeAdded
+    void changesMissed();
+
+    // True once changes have happened that the oracle could not absorb
+    bool needsRebuild() const;
+    size_t landmarkCount() const;
+
+    // Shared with the snapshot built on while that is still current
+    std::shared_ptr<const CSRGraph::NodeIndex> nodeIndex() const;
+
+    // Distance tables only; the node index is counted by RelationshipGraph
+    MemoryUsage memoryUsage() const;
+};
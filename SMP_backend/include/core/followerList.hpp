@@ -27,4 +27,7 @@ public:
                                 const HashMap<ull, const char *> &usernames);
 
     void removeUser(ull userID);
+
+    // The map plus every follower list it owns
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ADT/adjacency_set.hpp"
+#include "ADT/hash_map.hpp"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// MinHash signatures of every user's liked-post set, indexed by LSH bands.
+// The fraction of signature slots two users share estimates the Jaccard
+// similarity of their likes; users whose signatures agree on a whole band
+// of ROWS slots share that band's bucket. With 32 bands of 2 rows, pairs
+// above roughly 0.2 similarity are likely to share a bucket, so candidates
+// come from a few buckets instead of every liker of every liked post.
+//
+// Kept up to date on each like and unlike. A like only lowers slots; an
+// unlike recomputes the signature, but only when the post held a minimum.
+class InterestIndex
+{
+public:
+    static const size_t BANDS = 32;
+    static const size_t ROWS = 2;
+    static const size_t HASHES = BANDS * ROWS;
+
+private:
+    // Per-bucket cap on candidates read by similarUsers, so a bucket shared
+    // by many fans of the same viral posts costs a bounded amount
+    static const size_t BUCKET_SCAN = 256;
+
+    using Signature = std::array<uint32_t, HASHES>;
+
+    HashMap<NodeID, Signature> signatures; // users with at least one like
+    HashMap<uint64_t, AdjacencySet> buckets;
+
+    static uint32_t slotHash(NodeID post, size_t slot);
+    static uint64_t bandKey(const Signature &sig, size_t band);
+
+    // Moves user between buckets for every band that differs between before and after
+    void rebucket(NodeID user, const Signature *before, const Signature *after);
+
+public:
+    void liked(NodeID user, NodeID post);
+    // remaining: the user's liked posts after the unlike (null if none)
+    void unliked(NodeID user, NodeID post, const AdjacencySet *remaining);
+
+    // Estimated Jaccard similarity of two users' likes; 0 if either has none
+    double similarity(NodeID a, NodeID b) const;
+    // Users sharing a bucket with user, most similar first, without user
+    std::vector<std::pair<NodeID, double>> similarUsers(NodeID user) const;
+
+    MemoryUsage memoryUsage() const;
+};
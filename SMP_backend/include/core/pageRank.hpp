@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ADT/graph.hpp"
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct PageRankOptions
+{
+    double damping = 0.85;
+    // Stop once an iteration moves less than this much rank in total (L1)
+    double tolerance = 1e-6;
+    size_t maxIterations = 100;
+    // Teleport weights; empty teleports uniformly. Weights are normalised,
+    // and users missing from the graph are ignored.
+    std::vector<std::pair<NodeID, double>> personalization;
+};
+
+// PageRank over a follows snapshot by parallel power iteration. Each sweep
+// pulls rank along in-edges, so every node is written by exactly one thread
+// and no atomics are needed. Rank held by users who follow nobody is spread
+// along the teleport vector, keeping the total at 1.
+//
+// Scores are kept as one float per user, indexed by dense ID, so a lookup
+// is the snapshot's NodeID -> dense map plus an array read. Only that map is
+// kept from the snapshot, not its edges.
+class PageRank
+{
+private:
+    std::shared_ptr<const CSRGraph::NodeIndex> index; // numbering of the graph scored
+    std::vector<float> scores;                        // [dense ID]; sums to 1
+    size_t iterations = 0;
+    double residual = 0.0;               // L1 change of the last sweep
+
+public:
+    PageRank(std::shared_ptr<const CSRGraph> graph, const PageRankOptions &options = {});
+
+    // Share of the stationary distribution; 0 for users not in the snapshot
+    double score(NodeID user) const;
+    // Scaled so that the average user scores 1
+    double relativeScore(NodeID user) const;
+
+    size_t iterationCount() const;
+    // L1 change of the final sweep; below the tolerance if it converged
+    double lastChange() const;
+    size_t nodeCount() const;
+
+    // Shared with the snapshot scored while that is still current
+    std::shared_ptr<const CSRGraph::NodeIndex> nodeIndex() const;
+
+    // Score array only; the node index is counted by RelationshipGraph
+    MemoryUsage memoryUsage() const;
+};
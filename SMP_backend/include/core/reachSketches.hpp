@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ADT/graph.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Estimated number of users within 1..MAX_HOPS follow hops of every user,
+// computed HyperANF-style. Each user gets a HyperLogLog sketch of their own
+// ID; one round replaces every sketch with the register-wise max of itself
+// and the sketches of the users it follows, so after k rounds it describes
+// everyone within k hops. Each round is a parallel pass over the snapshot
+// costing O(edges * registers), with two rounds of sketches alive at a time.
+//
+// Only the per-hop estimates are kept afterwards, so a lookup is O(1). With
+// R registers the typical relative error is about 1.04 / sqrt(R).
+class ReachSketches
+{
+public:
+    static const int MAX_HOPS = 3;
+
+private:
+    std::shared_ptr<const CSRGraph::NodeIndex> index; // numbering of the graph sketched
+    std::vector<float> reach;                         // [node * MAX_HOPS + hops - 1]
+    size_t registers;
+
+public:
+    // registers is rounded to a power of two between 16 and 4096
+    ReachSketches(std::shared_ptr<const CSRGraph> graph, size_t registers = 64);
+
+    // Users reachable within hops (1..MAX_HOPS), not counting the user;
+    // -1 for users not in the snapshot
+    double estimate(NodeID user, int hops) const;
+
+    size_t registerCount() const;
+
+    // Shared with the snapshot sketched while that is still current
+    std::shared_ptr<const CSRGraph::NodeIndex> nodeIndex() const;
+
+    // Estimates only; the node index is counted by RelationshipGraph
+    MemoryUsage memoryUsage() const;
+};
@@ -1,10 +1,18 @@
 #pragma once
 
 #include "ADT/graph.hpp"
+#include "core/distanceOracle.hpp"
+#include "core/interestIndex.hpp"
+#include "core/communities.hpp"
+#include "core/pageRank.hpp"
+#include "core/reachSketches.hpp"
 #include "ADT/queue.hpp"
 #include "ADT/hash_map.hpp"
 #include <vector>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 
 enum class RelationType
 {
@@ -27,6 +35,13 @@ struct RecommendationScore
     std::string reason;
 };
 
+// Every user's clustering coefficient and the global one, as of one snapshot
+struct ClusteringStats
+{
+    HashMap<NodeID, double> coefficients;
+    double global = 0.0;
+};
+
 class RelationshipGraph
 {
 private:
@@ -35,10 +50,45 @@ private:
     Graph followsGraph;
     Queue<ActiveEdge> activeWindow;
 
+    // Read-only analytics run on CSR copies of followsGraph and likesGraph.
+    // They are rebuilt only by refreshSnapshots (periodic upkeep), never on
+    // read, so snapshot readers may miss changes made since the last upkeep.
+    size_t followsVersion = 0; // bumped under analyticsMutex, where the oracle build reads it
+    mutable size_t snapshotVersion = 0;
+    mutable std::shared_ptr<const CSRGraph> followsCSR;
+    size_t likesVersion = 0;
+    mutable size_t likesSnapshotVersion = 0;
+    mutable std::shared_ptr<const CSRGraph> likesCSR;
+    mutable std::mutex snapshotMutex;
+
+    // MinHash/LSH over each user's likes, updated by likePost and unlikePost
+    InterestIndex interests;
+
+    // Landmark distances for estimateShortestPathLength, once built; swapped
+    // in and updated under analyticsMutex
+    std::shared_ptr<DistanceOracle> distanceOracle;
+    size_t oracleLandmarks = 16;
+
+    // Latest PageRank, community partition, reach sketches and clustering
+    // coefficients of the follows graph, each replaced whole by its refresh
+    std::shared_ptr<const PageRank> influence;
+    std::shared_ptr<const Communities> communities;
+    std::shared_ptr<const ReachSketches> reach;
+    std::shared_ptr<const ClusteringStats> clustering;
+    mutable std::mutex analyticsMutex;
+    // Background refreshes; declared last so destruction waits for them first
+    std::future<void> influenceJob;
+    std::future<void> communityJob;
+    std::future<void> reachJob;
+    std::future<void> oracleJob;
+    std::future<void> clusteringJob;
+
     // Helper methods for traversal and recommendations
     void bfsHelper(NodeID start, std::function<bool(NodeID, int)> visitor, int maxDepth = -1) const;
-    void dfsHelper(NodeID start, HashMap<NodeID, bool> &visited,
+    void dfsHelper(const CSRGraph &csr, CSRGraph::DenseID current, std::vector<char> &visited,
                    std::function<bool(NodeID, int)> visitor, int depth = 0, int maxDepth = -1) const;
+    void dfsHelper(NodeID current, Set<NodeID> &visited,
+                   std::function<bool(NodeID, int)> visitor, int depth, int maxDepth) const;
 
 public:
     RelationshipGraph(size_t reserve);
@@ -53,11 +103,24 @@ public:
     bool isFollowing(NodeID follower, NodeID followee) const;
 
     // Followers/Following
-    const Set<NodeID> *getFollowers(NodeID user) const;
-    const Set<NodeID> *getFollowing(NodeID user) const;
+    const AdjacencySet *getFollowers(NodeID user) const;
+    const AdjacencySet *getFollowing(NodeID user) const;
     size_t followerCount(NodeID user) const;
     size_t followingCount(NodeID user) const;
 
+    // Newest built snapshots of the follows and likes graphs, as of the last
+    // refreshSnapshots (built here only if there is none yet); holders keep
+    // them alive across rebuilds
+    std::shared_ptr<const CSRGraph> followsSnapshot() const;
+    std::shared_ptr<const CSRGraph> likesSnapshot() const;
+    // Rebuilds each snapshot whose graph has changed since it was built.
+    // O(V + E) per rebuilt graph; readers keep the old one until the swap.
+    void refreshSnapshots();
+
+    // Pack a user's follow lists while they are inactive; the next follow or
+    // unfollow touching them unpacks the affected list
+    void compressUser(NodeID user);
+
     // Mutual Connections & Friends
     std::vector<NodeID> getFriends(NodeID user) const;
     std::vector<NodeID> getMutualConnections(NodeID user1, NodeID user2) const;
@@ -66,35 +129,123 @@ public:
     bool likePost(NodeID user, NodeID post);
     bool unlikePost(NodeID user, NodeID post);
     bool hasLiked(NodeID user, NodeID post) const;
-    const Set<NodeID> *getPostLikes(NodeID post) const;
+    const AdjacencySet *getPostLikes(NodeID post) const;
     size_t likedPostsCount(NodeID user) const;
 
     // Active Users (Time-based)
     void addActive(NodeID u1, NodeID u2, long long now);
     void expireActive(long long now);
-    const Set<NodeID> *getActiveWith(NodeID user) const;
+    const AdjacencySet *getActiveWith(NodeID user) const;
     void clearActive();
 
-    // Network Traversal (BFS/DFS)
+    // Network Traversal (BFS/DFS). Depth-bounded calls walk the live graph
+    // and cost about the size of the neighbourhood; unbounded ones (-1) run
+    // on the follows snapshot, so they may not see the latest follows.
     void bfs(NodeID start, std::function<bool(NodeID, int)> visitor, int maxDepth = -1) const;
     void dfs(NodeID start, std::function<bool(NodeID, int)> visitor, int maxDepth = -1) const;
     std::vector<NodeID> getReachableUsers(NodeID start, int maxDepth = -1) const;
 
+    // Level-synchronous BFS over the follows snapshot. Each level is expanded
+    // on the shared thread pool, top-down or bottom-up, whichever touches fewer
+    // edges. visitor runs on the calling thread, one level at a time; order
+    // within a level is unspecified.
+    void bfsParallel(NodeID start, int maxDepth, std::function<bool(NodeID, int)> visitor) const;
+
     // Friend-of-Friend
     std::vector<NodeID> getFriendOfFriend(NodeID user, int maxDepth = 2) const;
     HashMap<NodeID, int> getFoFWithDistance(NodeID user, int maxDepth = 2) const;
 
     // Graph-based Recommendation Heuristics
+    // Combined strategy: currently the random-walk recommender with its default budget
     std::vector<RecommendationScore> recommendUsers(NodeID user, size_t limit = 10) const;
+    // Random walks with restart from user, each step following a follow or
+    // hopping user -> liked post -> another liker. Candidates are ranked by
+    // visits. At most steps steps are taken, fewer once limit candidates are
+    // well sampled, so cost does not grow with the size of the neighbourhood.
+    std::vector<RecommendationScore> recommendByRandomWalk(NodeID user, size_t limit = 10, size_t steps = 10000,
+                                                           double restartProbability = 0.3) const;
     std::vector<RecommendationScore> recommendByMutualFriends(NodeID user, size_t limit = 10) const;
+    // Users with the most similar liked-post sets (estimated Jaccard), from the interest index
     std::vector<RecommendationScore> recommendByCommonInterests(NodeID user, size_t limit = 10) const;
     std::vector<RecommendationScore> recommendByPopularity(NodeID user, size_t limit = 10) const;
 
-    // Cycle Detection
+    // Influence (PageRank over the follows graph). refreshInfluenceScores
+    // runs on the calling thread; startInfluenceRefresh runs in the
+    // background on the current snapshot and returns false if a previous
+    // run is still going. Readers see the old scores until the swap.
+    void refreshInfluenceScores(const PageRankOptions &options = {});
+    bool startInfluenceRefresh(const PageRankOptions &options = {});
+    // Relative to the average user (1.0); 0 before the first refresh and for users added since
+    double getInfluenceScore(NodeID user) const;
+    // Null before the first refresh
+    std::shared_ptr<const PageRank> influenceScores() const;
+
+    // Periodic upkeep: refreshes the snapshots, then starts a background
+    // refresh of each analytic computed on an older follows snapshot than the
+    // current one (or never computed), and of the distance oracle once it is
+    // inexact, skipping any still running. Costs nothing when the graph is
+    // unchanged.
+    void startStaleRefreshes();
+
+    // Communities (label propagation over the follows graph), refreshed the
+    // same way as influence
+    void refreshCommunities(const LabelPropagationOptions &options = {});
+    bool startCommunityRefresh(const LabelPropagationOptions &options = {});
+    // Communities::NONE before the first refresh and for users added since
+    uint32_t getCommunity(NodeID user) const;
+    // Null before the first refresh
+    std::shared_ptr<const Communities> communityPartition() const;
+
+    // k-hop reach (HyperLogLog sketches over the follows graph), refreshed
+    // the same way as influence
+    void refreshReachEstimates(size_t registers = 64);
+    bool startReachRefresh(size_t registers = 64);
+    // Users within hops follow steps of user. O(1) from the sketches for
+    // 1..ReachSketches::MAX_HOPS; exact BFS otherwise, or before the first
+    // refresh and for users added since.
+    double estimateReach(NodeID user, int hops) const;
+    // Null before the first refresh
+    std::shared_ptr<const ReachSketches> reachSketches() const;
+
+    // Cycle Detection, on the follows snapshot
+    // Strongly connected component of every user in the follows graph
+    HashMap<NodeID, size_t> getComponentIDs() const;
     bool hasCycle() const;
-    std::vector<std::vector<NodeID>> findAllCycles() const;
+    // Elementary follow cycles (Johnson's algorithm within each component),
+    // each listed from its smallest ID. Stops after maxCycles; maxLength
+    // skips longer cycles (0 for no limit).
+    std::vector<std::vector<NodeID>> findAllCycles(size_t maxCycles = 1000, size_t maxLength = 0) const;
 
     // Network Statistics
     double getClusteringCoefficient(NodeID user) const;
-    int getShortestPathLength(NodeID from, NodeID to) const;
+    // Recomputes getClusteringCoefficient for every user at once, plus the
+    // global coefficient (all linked pairs over all possible pairs), on the
+    // calling thread or in the background like influence
+    void refreshClusteringStats();
+    bool startClusteringRefresh();
+    // Null before the first refresh
+    std::shared_ptr<const ClusteringStats> clusteringStats() const;
+    // As of the last refresh. Computed live before the first refresh and
+    // for users added since.
+    double getCachedClusteringCoefficient(NodeID user) const;
+    double getGlobalClusteringCoefficient() const;
+    // Follow hops from one user to another, or -1 if unreachable within
+    // maxDepth (-1 for no cap). Searches the live graph from both ends at
+    // once, keeping state only for the users it reaches.
+    int getShortestPathLength(NodeID from, NodeID to, int maxDepth = -1) const;
+    // One length per (from, to) pair, spread over the thread pool
+    std::vector<int> getShortestPathLengths(const std::vector<std::pair<NodeID, NodeID>> &pairs, int maxDepth = -1) const;
+
+    // O(landmarks) degrees of separation from the distance oracle; exact BFS
+    // when no oracle has been built
+    DistanceEstimate estimateShortestPathLength(NodeID from, NodeID to) const;
+    // Builds the oracle on the calling thread, or in the background like
+    // influence (false if a build is still running). startStaleRefreshes
+    // starts one when the oracle is missing or unfollows, new users or
+    // changes during its build have made answers inexact.
+    void buildDistanceOracle(size_t landmarks = 16);
+    bool startDistanceOracleRefresh(size_t landmarks = 16);
+
+    // All three graphs and the active window
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
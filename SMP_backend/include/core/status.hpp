@@ -15,4 +15,6 @@ public:
     bool isOnline(ull userID) const;
     const char *getStatusString(ull userID) const;
     void removeUser(ull userID);
+
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
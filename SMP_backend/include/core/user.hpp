@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <ctime>
 #include "ADT/hash_map.hpp"
 #include "utils/validation.hpp"
@@ -50,6 +51,8 @@ public:
 
     bool verifyPassword(const std::string &input) const;
     void display() const;
+
+    MemoryUsage memoryUsage() const;
 };
 
 // Simple dynamic array to avoid STL vector
@@ -142,8 +145,8 @@ public:
 
     // Expose user entities to other managers (via System Manager)
     User *getUserByID(ull userID) const;
-    User *getUserByUsername(const std::string &uname) const;
-    ull getUserIDByUsername(const std::string &uname) const;
+    User *getUserByUsername(std::string_view uname) const;
+    ull getUserIDByUsername(std::string_view uname) const;
 
     // Linear search for scanning profile fields
     DynamicArray<User *> searchByCity(const std::string &city) const;
@@ -165,6 +168,9 @@ public:
     bool validatePassword(const std::string &pwd) const;
     bool validateCity(const std::string &city) const;
 
+    // Both indexes plus the User objects they own
+    MemoryUsage memoryUsage() const;
+
     UserManager(const UserManager &) = delete;
     UserManager &operator=(const UserManager &) = delete;
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include <fstream>
 #include "nlohmann/json.hpp"
+#include "ADT/memory_usage.hpp"
 
 using json = nlohmann::json;
 
@@ -73,4 +74,6 @@ public:
 
     bool saveToFile() const;
     bool loadFromFile();
+
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <ctime>
 #include <vector>
 #include "ADT/hash_map.hpp"
@@ -48,6 +50,8 @@ public:
 
     std::string format() const;
 
+    MemoryUsage memoryUsage() const;
+
     bool operator==(const Message &other) const { return this->m_id == other.m_id; }
 };
 
@@ -59,10 +63,19 @@ private:
 
     std::string filePath;
 
-    std::string makeKey(unsigned long long a, unsigned long long b) const
+    // Two 20-digit IDs and the separator
+    static const size_t KEY_LEN = 41;
+
+    // Chat key "<smaller id>_<larger id>", written into buf so lookups never allocate
+    std::string_view makeKey(unsigned long long a, unsigned long long b, char *buf) const
     {
-        return (a < b) ? std::to_string(a) + "_" + std::to_string(b)
-                       : std::to_string(b) + "_" + std::to_string(a);
+        if (a > b)
+            std::swap(a, b);
+
+        char *end = std::to_chars(buf, buf + KEY_LEN, a).ptr;
+        *end++ = '_';
+        end = std::to_chars(end, buf + KEY_LEN, b).ptr;
+        return std::string_view(buf, end - buf);
     }
 
 public:
@@ -83,4 +96,7 @@ public:
 
     std::vector<Message> searchMessages(const User &user, const std::string &keyword) const;
     void clear();
+
+    // Every conversation queue including message text
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
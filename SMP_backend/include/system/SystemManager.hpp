@@ -56,6 +56,11 @@ private:
     NotificationManager *notifMgr; // Notification system
     FriendRequestManager *reqMgr;  // Friend request workflows
 
+    // When runPeriodicMaintenance last refreshed the graph analytics and the
+    // clustering stats (0: never)
+    long long lastAnalyticsRefresh;
+    long long lastClusteringRefresh;
+
     // =======================
     // Helper Methods
     // =======================
@@ -241,6 +246,14 @@ public:
     std::vector<ull> getMutualFriends(ull userID1, ull userID2) const;
     bool areUsersFriends(ull userID1, ull userID2) const;
 
+    /**
+     * Follow hops from viewer to profile (-1 if none found), from the landmark
+     * distance oracle. Where it only has an upper bound, that is returned with
+     * exact unset; requireExact runs a search capped at the bound instead.
+     * With no route through any landmark, searches a few hops out.
+     */
+    DistanceEstimate getDegreesOfSeparation(ull viewerID, ull profileID, bool requireExact = false) const;
+
     // =======================
     // FRIEND REQUEST OPERATIONS
     // =======================
@@ -387,6 +400,14 @@ public:
     std::vector<ull> getActiveConnections(ull userID) const;
     void clearAllActivities();
 
+    /**
+     * Called on every main-loop tick: expires old activities and, at most
+     * once a minute, recomputes in the background the graph analytics that
+     * follows changes have made stale. Clustering stats are recomputed on
+     * the first tick and then once a day.
+     */
+    void runPeriodicMaintenance();
+
     // =======================
     // ANALYTICS & STATISTICS
     // =======================
@@ -400,6 +421,7 @@ public:
         size_t totalLikes;
         size_t unreadNotifications;
         size_t pendingRequests;
+        long long twoHopReach; // estimate; -1 until the reach sketches cover the user
         bool isOnline;
     };
 
@@ -3,6 +3,7 @@
 #include <string>
 #include <ctime>
 #include "nlohmann/json.hpp"
+#include "ADT/pool_allocator.hpp"
 
 using json = nlohmann::json;
 
@@ -48,6 +49,8 @@ public:
 
     json toJSON() const;
     static Notification fromJSON(const json &data);
+
+    MemoryUsage memoryUsage() const;
 };
 
 class NotificationManager
@@ -61,6 +64,7 @@ private:
         UnreadNode *next;
     };
     UnreadNode *head;
+    PoolAllocator<UnreadNode> unreadPool; // read/unread churn reuses nodes
 
     std::string filePath;
 
@@ -95,4 +99,7 @@ public:
 
     bool empty() const;
     unsigned long long size() const;
+
+    // Notification array, the notifications and the unread list
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
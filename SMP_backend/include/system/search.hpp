@@ -46,4 +46,7 @@ public:
 
     // Multi-pattern search (uses Rabin-Karp)
     std::vector<Post *> multiPatternSearchPosts(const std::vector<std::string> &queries);
+
+    // Index structures only; users and posts belong to their managers
+    MemoryUsage memoryUsage() const;
 };
\ No newline at end of file
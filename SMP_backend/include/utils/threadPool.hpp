@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ADT/queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining one task queue. parallelFor is the
+// main entry point: it splits an index range into chunks that the workers
+// and the calling thread pull from until none are left.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    Queue<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Process-wide pool with one worker per hardware thread beyond the caller's
+    static ThreadPool &shared();
+
+    // Calls body(chunk, begin, end) for consecutive [begin, end) slices of
+    // [0, n), each grain long (the last may be shorter), and returns once all
+    // have run. chunk is the slice's index, so callers can give each slice
+    // its own output slot. Small ranges run inline on the calling thread.
+    // Not for use from inside a pool task: the nested wait could starve.
+    template <typename F>
+    void parallelFor(size_t n, size_t grain, F &&body)
+    {
+        if (grain == 0)
+            grain = 1;
+        size_t chunks = (n + grain - 1) / grain;
+
+        size_t helpers = std::min(workers.size(), chunks > 0 ? chunks - 1 : 0);
+        if (helpers == 0)
+        {
+            for (size_t c = 0; c < chunks; c++)
+                body(c, c * grain, std::min(n, (c + 1) * grain));
+            return;
+        }
+
+        std::atomic<size_t> nextChunk{0};
+        auto drain = [&]()
+        {
+            for (size_t c; (c = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks;)
+                body(c, c * grain, std::min(n, (c + 1) * grain));
+        };
+
+        std::mutex doneLock;
+        std::condition_variable doneWake;
+        size_t running = helpers;
+
+        for (size_t h = 0; h < helpers; h++)
+        {
+            submit([&]()
+                   {
+                drain();
+                std::lock_guard<std::mutex> guard(doneLock);
+                if (--running == 0)
+                    doneWake.notify_one(); });
+        }
+
+        drain();
+
+        // Helpers reference this frame, so wait for every one to finish
+        std::unique_lock<std::mutex> guard(doneLock);
+        doneWake.wait(guard, [&]
+                      { return running == 0; });
+    }
+};
@@ -166,29 +166,27 @@ std::vector<Post *> FeedManager::mergeKSortedLists(const std::vector<std::vector
 std::vector<Post *> FeedManager::getUserFeed(ull userID, size_t limit) const
 {
     // Get all users this user follows
-    const Set<NodeID> *following = rg->getFollowing(userID);
+    const AdjacencySet *following = rg->getFollowing(userID);
 
     if (!following || following->size() == 0)
         return {};
 
-    // Collect posts from all followed users (K sorted lists)
-    std::vector<std::vector<Post *>> allUserPosts;
-
-    const auto &followingData = following->data();
-    for (size_t i = 0; i < following->size(); i++)
+    // Followed users plus the user's own posts, fetched in one batched lookup
+    std::vector<ull> authors;
+    for (NodeID id : *following)
     {
-        ull followedUserID = followingData[i];
-        std::vector<Post *> userPosts = pm->getPostsByUser(followedUserID);
+        authors.push_back(id);
+    }
+    authors.push_back(userID);
 
+    // Collect posts from all of them (K sorted lists)
+    std::vector<std::vector<Post *>> allUserPosts;
+    for (std::vector<Post *> &userPosts : pm->getPostsByUsers(authors))
+    {
         if (!userPosts.empty())
-            allUserPosts.push_back(userPosts);
+            allUserPosts.push_back(std::move(userPosts));
     }
 
-    // Add user's own posts
-    std::vector<Post *> ownPosts = pm->getPostsByUser(userID);
-    if (!ownPosts.empty())
-        allUserPosts.push_back(ownPosts);
-
     // Merge K sorted lists (each user's posts are sorted newest first)
     return mergeKSortedLists(allUserPosts, limit);
 }
@@ -201,22 +199,17 @@ std::vector<Post *> FeedManager::getUserFeedByFriends(ull userID, size_t limit)
     if (friends.empty())
         return {};
 
-    // Collect posts from all friends
-    std::vector<std::vector<Post *>> allFriendPosts;
+    // Collect posts from all friends plus the user's own, in one batched lookup
+    std::vector<ull> authors(friends.begin(), friends.end());
+    authors.push_back(userID);
 
-    for (size_t i = 0; i < friends.size(); i++)
+    std::vector<std::vector<Post *>> allFriendPosts;
+    for (std::vector<Post *> &friendPosts : pm->getPostsByUsers(authors))
     {
-        std::vector<Post *> friendPosts = pm->getPostsByUser(friends[i]);
-
         if (!friendPosts.empty())
-            allFriendPosts.push_back(friendPosts);
+            allFriendPosts.push_back(std::move(friendPosts));
     }
 
-    // Add user's own posts
-    std::vector<Post *> ownPosts = pm->getPostsByUser(userID);
-    if (!ownPosts.empty())
-        allFriendPosts.push_back(ownPosts);
-
     // Merge K sorted lists
     return mergeKSortedLists(allFriendPosts, limit);
 }
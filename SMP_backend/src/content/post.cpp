@@ -76,6 +76,15 @@ void Post::display() const
               << " | Likes: " << getLikesCount() << "\n";
 }
 
+MemoryUsage Post::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, content);
+    addOwnedMemory(u, likes);
+    return u;
+}
+
 // ============================================================================
 // PostList Implementation (Linked List)
 // ============================================================================
@@ -90,7 +99,7 @@ PostList::~PostList()
 void PostList::addPost(Post *p)
 {
     // Add to front for newest-first ordering
-    PostNode *newNode = new PostNode(p);
+    PostNode *newNode = nodePool.create(p);
     newNode->next = head;
     head = newNode;
     count++;
@@ -110,7 +119,7 @@ bool PostList::removePost(ull postID)
             else
                 head = curr->next;
 
-            delete curr;
+            nodePool.destroy(curr);
             count--;
             return true;
         }
@@ -157,13 +166,23 @@ void PostList::clear()
     while (curr)
     {
         PostNode *next = curr->next;
-        delete curr;
+        nodePool.destroy(curr);
         curr = next;
     }
     head = nullptr;
     count = 0;
 }
 
+MemoryUsage PostList::memoryUsage() const
+{
+    MemoryUsage u;
+    u.payloadBytes = count * sizeof(Post *);
+    u.metadataBytes = sizeof(*this) + count * (sizeof(PostNode) - sizeof(Post *));
+    u.slotsUsed = count;
+    nodePool.accountMemory(u, count);
+    return u;
+}
+
 // ============================================================================
 // KMP String Matching for Post Search
 // ============================================================================
@@ -357,6 +376,19 @@ std::vector<Post *> PostManager::getPostsByUser(ull userID) const
     return (*userList)->getAllPosts();
 }
 
+std::vector<std::vector<Post *>> PostManager::getPostsByUsers(const std::vector<ull> &userIDs) const
+{
+    std::vector<PostList *const *> lists = userPosts.getMany(userIDs);
+    std::vector<std::vector<Post *>> result(userIDs.size());
+
+    for (size_t i = 0; i < lists.size(); i++)
+    {
+        if (lists[i])
+            result[i] = (*lists[i])->getAllPosts();
+    }
+    return result;
+}
+
 std::vector<Post *> PostManager::getAllPosts() const
 {
     std::vector<Post *> result;
@@ -518,4 +550,17 @@ void PostManager::displayAll() const
     {
         (*it).value->display();
     }
-}
\ No newline at end of file
+}
+
+MemoryUsage PostManager::memoryUsage() const
+{
+    MemoryUsage u = userPosts.memoryUsage();
+    u += postIndex.memoryUsage();
+
+    for (auto it = userPosts.begin(); it != userPosts.end(); ++it)
+        u.addBytesOf((*it).value->memoryUsage());
+
+    for (auto it = postIndex.begin(); it != postIndex.end(); ++it)
+        u.addBytesOf((*it).value->memoryUsage());
+    return u;
+}
@@ -2,6 +2,7 @@
 #include "ADT/hash_map.hpp"
 #include "ADT/set.hpp"
 #include "ADT/queue.hpp"
+#include <algorithm>
 #include <iostream>
 
 RecommendationEngine::RecommendationEngine(PostManager *pm, RelationshipGraph *rg)
@@ -22,14 +23,13 @@ std::vector<ull> RecommendationEngine::recommendUsers(ull userID, size_t limit)
     visited.insert(userID);
 
     // Get direct friends (depth 1) - we don't want to recommend them
-    const Set<NodeID> *directFriends = rg->getFollowing(userID);
+    const AdjacencySet *directFriends = rg->getFollowing(userID);
     Set<ull> alreadyFollowing;
     if (directFriends)
     {
-        const auto &data = directFriends->data();
-        for (size_t i = 0; i < directFriends->size(); i++)
+        for (NodeID id : *directFriends)
         {
-            alreadyFollowing.insert(data[i]);
+            alreadyFollowing.insert(id);
         }
     }
 
@@ -47,15 +47,12 @@ std::vector<ull> RecommendationEngine::recommendUsers(ull userID, size_t limit)
             continue;
 
         // Get neighbors of current node
-        const Set<NodeID> *neighbors = rg->getFollowing(node);
+        const AdjacencySet *neighbors = rg->getFollowing(node);
         if (!neighbors)
             continue;
 
-        const auto &data = neighbors->data();
-        for (size_t i = 0; i < neighbors->size(); i++)
+        for (ull neighbor : *neighbors)
         {
-            ull neighbor = data[i];
-
             // Count frequency for depth-2 nodes (friends of friends)
             if (depth == 1)
             {
@@ -148,14 +145,13 @@ std::vector<Post *> RecommendationEngine::recommendPosts(ull userID, size_t limi
     visited.insert(userID);
 
     // Get direct friends
-    const Set<NodeID> *directFriends = rg->getFollowing(userID);
+    const AdjacencySet *directFriends = rg->getFollowing(userID);
     Set<ull> friends;
     if (directFriends)
     {
-        const auto &data = directFriends->data();
-        for (size_t i = 0; i < directFriends->size(); i++)
+        for (NodeID id : *directFriends)
         {
-            friends.insert(data[i]);
+            friends.insert(id);
         }
     }
 
@@ -173,15 +169,12 @@ std::vector<Post *> RecommendationEngine::recommendPosts(ull userID, size_t limi
         if (depth >= 2)
             continue;
 
-        const Set<NodeID> *neighbors = rg->getFollowing(node);
+        const AdjacencySet *neighbors = rg->getFollowing(node);
         if (!neighbors)
             continue;
 
-        const auto &data = neighbors->data();
-        for (size_t i = 0; i < neighbors->size(); i++)
+        for (ull neighbor : *neighbors)
         {
-            ull neighbor = data[i];
-
             // Collect posts from depth-1 and depth-2 users
             if (depth >= 0 && neighbor != userID)
             {
@@ -196,6 +189,15 @@ std::vector<Post *> RecommendationEngine::recommendPosts(ull userID, size_t limi
         }
     }
 
+    // Authors in the user's own community first, otherwise in BFS order
+    std::shared_ptr<const Communities> partition = rg->communityPartition();
+    if (partition && partition->communityOf(userID) != Communities::NONE)
+    {
+        uint32_t home = partition->communityOf(userID);
+        std::stable_partition(candidateUsers.begin(), candidateUsers.end(), [&](ull candidate)
+                              { return partition->communityOf(candidate) == home; });
+    }
+
     // Get posts from candidate users
     for (size_t i = 0; i < candidateUsers.size(); i++)
     {
@@ -220,16 +222,35 @@ std::vector<Post *> RecommendationEngine::recommendPosts(ull userID, size_t limi
 }
 
 // ============================================================================
-// Trending Posts using Top-K ranking by likes
+// Trending Posts using Top-K ranking by influence-weighted likes
 // ============================================================================
 std::vector<Post *> RecommendationEngine::recommendTrendingPosts(size_t limit) const
 {
     std::vector<Post *> all = pm->getAllPosts();
 
-    // Top-K selection using manual sorting by likes count
+    // Each like counts by the liker's influence (1.0 for an average user),
+    // so likes from throwaway accounts add little. Plain like counts until
+    // influence scores have been computed.
+    std::shared_ptr<const PageRank> influence = rg->influenceScores();
+    HashMap<ull, double> heat;
+    heat.reserve(all.size());
+    for (Post *post : all)
+    {
+        double h = static_cast<double>(post->getLikesCount());
+        const AdjacencySet *likers = influence ? rg->getPostLikes(post->getPostID()) : nullptr;
+        if (likers)
+        {
+            h = 0.0;
+            for (NodeID liker : *likers)
+                h += influence->relativeScore(liker);
+        }
+        heat.insert(post->getPostID(), h);
+    }
+
+    // Top-K selection using manual sorting by weighted likes
     if (all.size() > 1)
     {
-        auto sortFunc = [](std::vector<Post *> &arr, int low, int high, auto &self) -> void
+        auto sortFunc = [&heat](std::vector<Post *> &arr, int low, int high, auto &self) -> void
         {
             if (low < high)
             {
@@ -238,8 +259,8 @@ std::vector<Post *> RecommendationEngine::recommendTrendingPosts(size_t limit) c
 
                 for (int j = low; j < high; j++)
                 {
-                    // Sort by likes descending
-                    if (arr[j]->getLikesCount() > pivot->getLikesCount())
+                    // Sort by weighted likes descending
+                    if (*heat.get(arr[j]->getPostID()) > *heat.get(pivot->getPostID()))
                     {
                         i++;
                         Post *temp = arr[i];
@@ -0,0 +1,161 @@
+#include "core/communities.hpp"
+#include "utils/threadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+static const size_t PROPAGATION_GRAIN = 1024; // users per task
+
+Communities::Communities(std::shared_ptr<const CSRGraph> graph, const LabelPropagationOptions &options)
+    : index(graph->nodeIndex())
+{
+    const CSRGraph &csr = *graph;
+    size_t n = csr.nodeCount();
+
+    // Relaxed atomics: tasks read neighbours' labels while others rewrite them
+    std::vector<std::atomic<uint32_t>> label(n);
+    std::vector<CSRGraph::DenseID> order(n);
+    for (size_t d = 0; d < n; d++)
+    {
+        label[d].store(static_cast<uint32_t>(d), std::memory_order_relaxed);
+        order[d] = static_cast<CSRGraph::DenseID>(d);
+    }
+
+    // Visiting in ID order would let low labels sweep along ID runs
+    std::mt19937 rng(1);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    size_t chunks = (n + PROPAGATION_GRAIN - 1) / PROPAGATION_GRAIN;
+    std::vector<size_t> changedParts(chunks);
+
+    while (passes < options.maxIterations)
+    {
+        ThreadPool::shared().parallelFor(n, PROPAGATION_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                                         {
+            std::vector<uint32_t> seen;
+            size_t changed = 0;
+
+            for (size_t i = begin; i < end; i++)
+            {
+                CSRGraph::DenseID v = order[i];
+                seen.clear();
+                for (CSRGraph::DenseID w : csr.outNeighbors(v))
+                    seen.push_back(label[w].load(std::memory_order_relaxed));
+                for (CSRGraph::DenseID w : csr.inNeighbors(v))
+                    seen.push_back(label[w].load(std::memory_order_relaxed));
+                if (seen.empty())
+                    continue;
+
+                std::sort(seen.begin(), seen.end());
+
+                // Most frequent label; the current one wins ties, then the smallest
+                uint32_t current = label[v].load(std::memory_order_relaxed);
+                uint32_t best = current;
+                size_t bestCount = 0;
+                for (size_t run = 0; run < seen.size();)
+                {
+                    size_t next = run;
+                    while (next < seen.size() && seen[next] == seen[run])
+                        next++;
+
+                    size_t count = next - run;
+                    if (count > bestCount || (count == bestCount && seen[run] == current))
+                    {
+                        best = seen[run];
+                        bestCount = count;
+                    }
+                    run = next;
+                }
+
+                if (best != current)
+                {
+                    label[v].store(best, std::memory_order_relaxed);
+                    changed++;
+                }
+            }
+            changedParts[chunk] = changed; });
+
+        passes++;
+
+        size_t changed = 0;
+        for (size_t part : changedParts)
+            changed += part;
+        if (static_cast<double>(changed) < options.tolerance * static_cast<double>(n))
+            break;
+    }
+
+    // Renumber labels densely, in order of each community's smallest member
+    std::vector<uint32_t> renumber(n, NONE);
+    community.resize(n);
+    uint32_t count = 0;
+    for (size_t d = 0; d < n; d++)
+    {
+        uint32_t l = label[d].load(std::memory_order_relaxed);
+        if (renumber[l] == NONE)
+            renumber[l] = count++;
+        community[d] = renumber[l];
+    }
+
+    // Counting sort of members by community
+    offsets.assign(count + 1, 0);
+    for (uint32_t c : community)
+        offsets[c + 1]++;
+    for (uint32_t c = 0; c < count; c++)
+        offsets[c + 1] += offsets[c];
+
+    members.resize(n);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t d = 0; d < n; d++)
+        members[fill[community[d]]++] = static_cast<CSRGraph::DenseID>(d);
+}
+
+uint32_t Communities::communityOf(NodeID user) const
+{
+    CSRGraph::DenseID d = index->denseID(user);
+    return d == CSRGraph::NONE ? NONE : community[d];
+}
+
+bool Communities::sameCommunity(NodeID a, NodeID b) const
+{
+    uint32_t ca = communityOf(a);
+    return ca != NONE && ca == communityOf(b);
+}
+
+size_t Communities::communityCount() const
+{
+    return offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+size_t Communities::communitySize(uint32_t c) const
+{
+    return offsets[c + 1] - offsets[c];
+}
+
+std::vector<NodeID> Communities::communityMembers(uint32_t c) const
+{
+    std::vector<NodeID> ids;
+    ids.reserve(communitySize(c));
+    for (uint32_t i = offsets[c]; i < offsets[c + 1]; i++)
+        ids.push_back(index->nodeID(members[i]));
+    return ids;
+}
+
+size_t Communities::passCount() const
+{
+    return passes;
+}
+
+std::shared_ptr<const CSRGraph::NodeIndex> Communities::nodeIndex() const
+{
+    return index;
+}
+
+MemoryUsage Communities::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, community);
+    addOwnedMemory(u, offsets);
+    addOwnedMemory(u, members);
+    return u;
+}
@@ -0,0 +1,217 @@
+#include "core/distanceOracle.hpp"
+#include "utils/threadPool.hpp"
+#include <algorithm>
+#include <climits>
+
+DistanceOracle::DistanceOracle(std::shared_ptr<const CSRGraph> graph, size_t landmarkCount)
+    : index(graph->nodeIndex())
+{
+    const CSRGraph &csr = *graph;
+    size_t n = csr.nodeCount();
+    landmarkCount = std::min(landmarkCount, n);
+
+    // Highest total degree first: hubs sit on the most shortest paths
+    std::vector<CSRGraph::DenseID> byDegree(n);
+    for (size_t d = 0; d < n; d++)
+        byDegree[d] = static_cast<CSRGraph::DenseID>(d);
+
+    std::partial_sort(byDegree.begin(), byDegree.begin() + landmarkCount, byDegree.end(),
+                      [&](CSRGraph::DenseID a, CSRGraph::DenseID b)
+                      {
+                          size_t da = csr.outDegree(a) + csr.inDegree(a);
+                          size_t db = csr.outDegree(b) + csr.inDegree(b);
+                          return da != db ? da > db : a < b;
+                      });
+    landmarks.assign(byDegree.begin(), byDegree.begin() + landmarkCount);
+
+    fromLandmark.assign(n * landmarkCount, UNREACHED);
+    toLandmark.assign(n * landmarkCount, UNREACHED);
+    fromComplete.assign(landmarkCount, 1);
+    toComplete.assign(landmarkCount, 1);
+
+    // Every (landmark, direction) BFS writes its own column
+    ThreadPool::shared().parallelFor(2 * landmarkCount, 1, [&](size_t job, size_t, size_t)
+                                     { bfsFrom(csr, job / 2, job % 2 == 0); });
+}
+
+void DistanceOracle::bfsFrom(const CSRGraph &csr, size_t k, bool forward)
+{
+    size_t K = landmarks.size();
+    std::vector<uint8_t> &dist = forward ? fromLandmark : toLandmark;
+
+    std::vector<CSRGraph::DenseID> frontier{landmarks[k]};
+    std::vector<CSRGraph::DenseID> next;
+    dist[landmarks[k] * K + k] = 0;
+
+    for (uint8_t depth = 0; !frontier.empty(); depth++)
+    {
+        if (depth == MAX_HOPS)
+        {
+            (forward ? fromComplete : toComplete)[k] = 0;
+            return;
+        }
+
+        for (CSRGraph::DenseID node : frontier)
+        {
+            CSRGraph::Range neighbors = forward ? csr.outNeighbors(node) : csr.inNeighbors(node);
+            for (CSRGraph::DenseID neighbor : neighbors)
+            {
+                uint8_t &d = dist[neighbor * K + k];
+                if (d == UNREACHED)
+                {
+                    d = depth + 1;
+                    next.push_back(neighbor);
+                }
+            }
+        }
+
+        frontier.swap(next);
+        next.clear();
+    }
+}
+
+DistanceEstimate DistanceOracle::estimate(NodeID from, NodeID to) const
+{
+    if (from == to)
+        return {0, true};
+
+    CSRGraph::DenseID s = index->denseID(from);
+    CSRGraph::DenseID t = index->denseID(to);
+    if (s == CSRGraph::NONE || t == CSRGraph::NONE)
+        return {-1, false};
+
+    size_t K = landmarks.size();
+    const uint8_t *fromS = &fromLandmark[s * K];
+    const uint8_t *fromT = &fromLandmark[t * K];
+    const uint8_t *toS = &toLandmark[s * K];
+    const uint8_t *toT = &toLandmark[t * K];
+
+    int upper = INT_MAX;
+    int lower = 0;
+    bool disconnected = false;
+
+    for (size_t k = 0; k < K; k++)
+    {
+        // s -> landmark -> t
+        if (toS[k] != UNREACHED && fromT[k] != UNREACHED)
+            upper = std::min(upper, toS[k] + fromT[k]);
+
+        // d(L, t) <= d(L, s) + d(s, t)  and  d(s, L) <= d(s, t) + d(t, L)
+        if (fromS[k] != UNREACHED && fromT[k] != UNREACHED)
+            lower = std::max(lower, fromT[k] - fromS[k]);
+        if (toS[k] != UNREACHED && toT[k] != UNREACHED)
+            lower = std::max(lower, toS[k] - toT[k]);
+
+        // A landmark that reaches s but not t (or is reached from t but
+        // not from s) proves there is no path. Removals only disconnect
+        // more, so this survives unfollows, but not paths through new users.
+        if (fromComplete[k] && fromS[k] != UNREACHED && fromT[k] == UNREACHED)
+            disconnected = true;
+        if (toComplete[k] && toT[k] != UNREACHED && toS[k] == UNREACHED)
+            disconnected = true;
+    }
+
+    if (disconnected && !nodesAdded)
+        return {-1, true};
+    if (upper == INT_MAX)
+        return {-1, false};
+    return {upper, missedChanges == 0 && lower == upper};
+}
+
+void DistanceOracle::relax(const Graph &g, size_t k, NodeID start, uint8_t dist, bool forward)
+{
+    size_t K = landmarks.size();
+    std::vector<uint8_t> &table = forward ? fromLandmark : toLandmark;
+
+    CSRGraph::DenseID d = index->denseID(start);
+    if (d == CSRGraph::NONE || dist >= table[d * K + k])
+        return;
+    table[d * K + k] = dist;
+
+    // Only distances that actually shrink spread further
+    std::vector<NodeID> frontier{start};
+    std::vector<NodeID> next;
+    for (; !frontier.empty() && dist < MAX_HOPS; dist++)
+    {
+        for (NodeID node : frontier)
+        {
+            const AdjacencySet *neighbors = forward ? g.outNeighbors(node) : g.inNeighbors(node);
+            if (!neighbors)
+                continue;
+
+            for (NodeID neighbor : *neighbors)
+            {
+                CSRGraph::DenseID nd = index->denseID(neighbor);
+                if (nd != CSRGraph::NONE && dist + 1 < table[nd * K + k])
+                {
+                    table[nd * K + k] = dist + 1;
+                    next.push_back(neighbor);
+                }
+            }
+        }
+
+        frontier.swap(next);
+        next.clear();
+    }
+}
+
+void DistanceOracle::edgeAdded(const Graph &g, NodeID from, NodeID to)
+{
+    CSRGraph::DenseID s = index->denseID(from);
+    CSRGraph::DenseID t = index->denseID(to);
+    if (s == CSRGraph::NONE || t == CSRGraph::NONE)
+        return;
+
+    size_t K = landmarks.size();
+    for (size_t k = 0; k < K; k++)
+    {
+        // landmark -> from -> to, and from -> to -> landmark
+        if (fromLandmark[s * K + k] < MAX_HOPS)
+            relax(g, k, to, fromLandmark[s * K + k] + 1, true);
+        if (toLandmark[t * K + k] < MAX_HOPS)
+            relax(g, k, from, toLandmark[t * K + k] + 1, false);
+    }
+}
+
+void DistanceOracle::edgeRemoved()
+{
+    missedChanges++;
+}
+
+void DistanceOracle::nodeAdded()
+{
+    nodesAdded = true;
+    missedChanges++;
+}
+
+void DistanceOracle::changesMissed()
+{
+    nodeAdded();
+}
+
+bool DistanceOracle::needsRebuild() const
+{
+    return missedChanges > 0;
+}
+
+size_t DistanceOracle::landmarkCount() const
+{
+    return landmarks.size();
+}
+
+std::shared_ptr<const CSRGraph::NodeIndex> DistanceOracle::nodeIndex() const
+{
+    return index;
+}
+
+MemoryUsage DistanceOracle::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, landmarks);
+    addOwnedMemory(u, fromLandmark);
+    addOwnedMemory(u, toLandmark);
+    addOwnedMemory(u, fromComplete);
+    addOwnedMemory(u, toComplete);
+    return u;
+}
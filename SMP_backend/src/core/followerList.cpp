@@ -146,4 +146,16 @@ void FollowerList::removeUser(ull userID)
     }
 
     followersMap.remove(userID);
-}
\ No newline at end of file
+}
+
+MemoryUsage FollowerList::memoryUsage() const
+{
+    MemoryUsage u = followersMap.memoryUsage();
+
+    for (auto it = followersMap.begin(); it != followersMap.end(); ++it)
+    {
+        if ((*it).value)
+            u.addBytesOf((*it).value->memoryUsage());
+    }
+    return u;
+}
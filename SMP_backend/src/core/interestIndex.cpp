@@ -0,0 +1,151 @@
+#include "core/interestIndex.hpp"
+#include <algorithm>
+
+uint32_t InterestIndex::slotHash(NodeID post, size_t slot)
+{
+    return static_cast<uint32_t>(hashMix64(post + slot * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+uint64_t InterestIndex::bandKey(const Signature &sig, size_t band)
+{
+    uint64_t key = hashMix64(band + 1);
+    for (size_t r = 0; r < ROWS; r++)
+        key = hashMix64(key ^ sig[band * ROWS + r]);
+    return key;
+}
+
+void InterestIndex::rebucket(NodeID user, const Signature *before, const Signature *after)
+{
+    for (size_t band = 0; band < BANDS; band++)
+    {
+        if (before && after &&
+            std::equal(before->begin() + band * ROWS, before->begin() + (band + 1) * ROWS, after->begin() + band * ROWS))
+            continue;
+
+        if (before)
+        {
+            uint64_t key = bandKey(*before, band);
+            AdjacencySet *bucket = buckets.get(key);
+            if (bucket)
+            {
+                bucket->erase(user);
+                if (bucket->size() == 0)
+                    buckets.remove(key);
+            }
+        }
+
+        if (after)
+            buckets.try_emplace(bandKey(*after, band)).first->insert(user);
+    }
+}
+
+void InterestIndex::liked(NodeID user, NodeID post)
+{
+    Signature *sig = signatures.get(user);
+    if (!sig)
+    {
+        Signature fresh;
+        for (size_t i = 0; i < HASHES; i++)
+            fresh[i] = slotHash(post, i);
+
+        signatures.insert(user, fresh);
+        rebucket(user, nullptr, &fresh);
+        return;
+    }
+
+    Signature before = *sig;
+    bool lowered = false;
+    for (size_t i = 0; i < HASHES; i++)
+    {
+        uint32_t h = slotHash(post, i);
+        if (h < (*sig)[i])
+        {
+            (*sig)[i] = h;
+            lowered = true;
+        }
+    }
+
+    if (lowered)
+        rebucket(user, &before, sig);
+}
+
+void InterestIndex::unliked(NodeID user, NodeID post, const AdjacencySet *remaining)
+{
+    Signature *sig = signatures.get(user);
+    if (!sig)
+        return;
+
+    bool heldMinimum = false;
+    for (size_t i = 0; i < HASHES && !heldMinimum; i++)
+        heldMinimum = slotHash(post, i) == (*sig)[i];
+    if (!heldMinimum)
+        return;
+
+    Signature before = *sig;
+    if (!remaining || remaining->size() == 0)
+    {
+        rebucket(user, &before, nullptr);
+        signatures.remove(user);
+        return;
+    }
+
+    sig->fill(UINT32_MAX);
+    for (NodeID liked : *remaining)
+    {
+        for (size_t i = 0; i < HASHES; i++)
+            (*sig)[i] = std::min((*sig)[i], slotHash(liked, i));
+    }
+    rebucket(user, &before, sig);
+}
+
+double InterestIndex::similarity(NodeID a, NodeID b) const
+{
+    const Signature *sa = signatures.get(a);
+    const Signature *sb = signatures.get(b);
+    if (!sa || !sb)
+        return 0.0;
+
+    size_t same = 0;
+    for (size_t i = 0; i < HASHES; i++)
+        same += (*sa)[i] == (*sb)[i];
+    return static_cast<double>(same) / HASHES;
+}
+
+std::vector<std::pair<NodeID, double>> InterestIndex::similarUsers(NodeID user) const
+{
+    const Signature *sig = signatures.get(user);
+    if (!sig)
+        return {};
+
+    HashMap<NodeID, char> seen;
+    std::vector<std::pair<NodeID, double>> matches;
+
+    for (size_t band = 0; band < BANDS; band++)
+    {
+        const AdjacencySet *bucket = buckets.get(bandKey(*sig, band));
+        if (!bucket)
+            continue;
+
+        size_t scanned = 0;
+        for (NodeID candidate : *bucket)
+        {
+            if (scanned++ == BUCKET_SCAN)
+                break;
+            if (candidate == user || !seen.insert(candidate, 1))
+                continue;
+            matches.push_back({candidate, similarity(user, candidate)});
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const std::pair<NodeID, double> &a, const std::pair<NodeID, double> &b)
+              { return a.second != b.second ? a.second > b.second : a.first < b.first; });
+    return matches;
+}
+
+MemoryUsage InterestIndex::memoryUsage() const
+{
+    MemoryUsage u = signatures.memoryUsage();
+    u += buckets.memoryUsage();
+    u.metadataBytes += sizeof(*this) - sizeof(signatures) - sizeof(buckets);
+    return u;
+}
@@ -0,0 +1,150 @@
+#include "core/pageRank.hpp"
+#include "utils/threadPool.hpp"
+#include <cmath>
+
+static const size_t RANK_GRAIN = 4096; // nodes per task
+
+PageRank::PageRank(std::shared_ptr<const CSRGraph> graph, const PageRankOptions &options)
+    : index(graph->nodeIndex())
+{
+    const CSRGraph &csr = *graph;
+    size_t n = csr.nodeCount();
+    if (n == 0)
+        return;
+
+    // Teleport distribution; left empty for uniform
+    std::vector<double> teleport;
+    if (!options.personalization.empty())
+    {
+        double total = 0.0;
+        teleport.assign(n, 0.0);
+        for (const auto &entry : options.personalization)
+        {
+            CSRGraph::DenseID d = csr.denseID(entry.first);
+            if (d != CSRGraph::NONE && entry.second > 0.0)
+            {
+                teleport[d] += entry.second;
+                total += entry.second;
+            }
+        }
+
+        if (total > 0.0)
+        {
+            for (double &t : teleport)
+                t /= total;
+        }
+        else
+        {
+            teleport.clear();
+        }
+    }
+
+    double uniform = 1.0 / static_cast<double>(n);
+    double damping = options.damping;
+
+    std::vector<double> rank(n);
+    for (size_t d = 0; d < n; d++)
+        rank[d] = teleport.empty() ? uniform : teleport[d];
+
+    std::vector<double> next(n);
+    std::vector<double> share(n); // rank[u] / outDegree(u)
+
+    size_t chunks = (n + RANK_GRAIN - 1) / RANK_GRAIN;
+    std::vector<double> danglingParts(chunks);
+    std::vector<double> changeParts(chunks);
+    ThreadPool &pool = ThreadPool::shared();
+
+    while (iterations < options.maxIterations)
+    {
+        pool.parallelFor(n, RANK_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                         {
+            double dangling = 0.0;
+            for (size_t u = begin; u < end; u++)
+            {
+                size_t degree = csr.outDegree(static_cast<CSRGraph::DenseID>(u));
+                if (degree == 0)
+                {
+                    dangling += rank[u];
+                    share[u] = 0.0;
+                }
+                else
+                {
+                    share[u] = rank[u] / static_cast<double>(degree);
+                }
+            }
+            danglingParts[chunk] = dangling; });
+
+        // Summed in chunk order so the result does not depend on thread count
+        double dangling = 0.0;
+        for (double part : danglingParts)
+            dangling += part;
+        double spread = damping * dangling + (1.0 - damping);
+
+        pool.parallelFor(n, RANK_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                         {
+            double change = 0.0;
+            for (size_t v = begin; v < end; v++)
+            {
+                double sum = 0.0;
+                for (CSRGraph::DenseID u : csr.inNeighbors(static_cast<CSRGraph::DenseID>(v)))
+                    sum += share[u];
+
+                next[v] = damping * sum + spread * (teleport.empty() ? uniform : teleport[v]);
+                change += std::fabs(next[v] - rank[v]);
+            }
+            changeParts[chunk] = change; });
+
+        rank.swap(next);
+        iterations++;
+
+        residual = 0.0;
+        for (double part : changeParts)
+            residual += part;
+        if (residual < options.tolerance)
+            break;
+    }
+
+    scores.assign(rank.begin(), rank.end());
+}
+
+double PageRank::score(NodeID user) const
+{
+    if (scores.empty())
+        return 0.0;
+
+    CSRGraph::DenseID d = index->denseID(user);
+    return d == CSRGraph::NONE ? 0.0 : scores[d];
+}
+
+double PageRank::relativeScore(NodeID user) const
+{
+    return score(user) * static_cast<double>(scores.size());
+}
+
+size_t PageRank::iterationCount() const
+{
+    return iterations;
+}
+
+double PageRank::lastChange() const
+{
+    return residual;
+}
+
+size_t PageRank::nodeCount() const
+{
+    return scores.size();
+}
+
+std::shared_ptr<const CSRGraph::NodeIndex> PageRank::nodeIndex() const
+{
+    return index;
+}
+
+MemoryUsage PageRank::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, scores);
+    return u;
+}
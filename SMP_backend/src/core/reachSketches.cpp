@@ -0,0 +1,139 @@
+#include "core/reachSketches.hpp"
+#include "utils/threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const size_t SKETCH_GRAIN = 1024; // users per task
+
+// splitmix64 finaliser: user IDs are often sequential, registers need them spread
+static uint64_t mixID(NodeID id)
+{
+    uint64_t x = static_cast<uint64_t>(id) + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// HyperLogLog estimate with the small-range (linear counting) correction
+static double estimateSketch(const uint8_t *sketch, size_t m, const double *inversePowers)
+{
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t j = 0; j < m; j++)
+    {
+        sum += inversePowers[sketch[j]];
+        zeros += sketch[j] == 0;
+    }
+
+    double alpha = m == 16 ? 0.673 : m == 32 ? 0.697
+                                 : m == 64   ? 0.709
+                                             : 0.7213 / (1.0 + 1.079 / static_cast<double>(m));
+    double raw = alpha * static_cast<double>(m) * static_cast<double>(m) / sum;
+
+    if (raw <= 2.5 * static_cast<double>(m) && zeros > 0)
+        return static_cast<double>(m) * std::log(static_cast<double>(m) / static_cast<double>(zeros));
+    return raw;
+}
+
+ReachSketches::ReachSketches(std::shared_ptr<const CSRGraph> graph, size_t requested)
+    : index(graph->nodeIndex()), registers(16)
+{
+    unsigned bits = 4;
+    while (registers < requested && registers < 4096)
+    {
+        registers <<= 1;
+        bits++;
+    }
+
+    const CSRGraph &csr = *graph;
+    size_t n = csr.nodeCount();
+    size_t m = registers;
+    reach.assign(n * MAX_HOPS, 0.0f);
+
+    double inversePowers[66];
+    for (int r = 0; r < 66; r++)
+        inversePowers[r] = std::ldexp(1.0, -r);
+
+    // Round 0: every sketch holds just its own user
+    std::vector<uint8_t> current(n * m, 0);
+    for (size_t d = 0; d < n; d++)
+    {
+        uint64_t h = mixID(csr.nodeID(static_cast<CSRGraph::DenseID>(d)));
+        uint64_t rest = h << bits;
+        uint8_t rank = 1;
+        while (rank <= 64 - bits && !(rest & (1ull << 63)))
+        {
+            rest <<= 1;
+            rank++;
+        }
+        current[d * m + (h >> (64 - bits))] = rank;
+    }
+
+    std::vector<uint8_t> next(n * m);
+    size_t chunks = (n + SKETCH_GRAIN - 1) / SKETCH_GRAIN;
+    std::vector<char> changedParts(chunks);
+
+    int hops = 1;
+    for (; hops <= MAX_HOPS; hops++)
+    {
+        ThreadPool::shared().parallelFor(n, SKETCH_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                                         {
+            bool changed = false;
+            for (size_t d = begin; d < end; d++)
+            {
+                uint8_t *out = &next[d * m];
+                const uint8_t *own = &current[d * m];
+                std::copy(own, own + m, out);
+
+                for (CSRGraph::DenseID w : csr.outNeighbors(static_cast<CSRGraph::DenseID>(d)))
+                {
+                    const uint8_t *theirs = &current[static_cast<size_t>(w) * m];
+                    for (size_t j = 0; j < m; j++)
+                        out[j] = std::max(out[j], theirs[j]);
+                }
+
+                changed = changed || !std::equal(own, own + m, out);
+                double ball = estimateSketch(out, m, inversePowers);
+                reach[d * MAX_HOPS + hops - 1] = static_cast<float>(std::max(0.0, ball - 1.0));
+            }
+            changedParts[chunk] = changed; });
+
+        current.swap(next);
+
+        // Once no sketch grows, the deeper balls are the same as this one
+        if (std::find(changedParts.begin(), changedParts.end(), 1) == changedParts.end())
+            break;
+    }
+
+    for (int fill = hops + 1; fill <= MAX_HOPS; fill++)
+    {
+        for (size_t d = 0; d < n; d++)
+            reach[d * MAX_HOPS + fill - 1] = reach[d * MAX_HOPS + hops - 1];
+    }
+}
+
+double ReachSketches::estimate(NodeID user, int hops) const
+{
+    CSRGraph::DenseID d = index->denseID(user);
+    if (d == CSRGraph::NONE || hops < 1 || hops > MAX_HOPS)
+        return -1.0;
+    return reach[static_cast<size_t>(d) * MAX_HOPS + hops - 1];
+}
+
+size_t ReachSketches::registerCount() const
+{
+    return registers;
+}
+
+std::shared_ptr<const CSRGraph::NodeIndex> ReachSketches::nodeIndex() const
+{
+    return index;
+}
+
+MemoryUsage ReachSketches::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, reach);
+    return u;
+}
@@ -2,7 +2,12 @@
 #include "ADT/hash_map.hpp"
 #include "ADT/set.hpp"
 #include "ADT/queue.hpp"
+#include "utils/threadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <random>
 
 // Manual sorting helper (QuickSort)
 template <typename T, typename Compare>
@@ -52,7 +57,13 @@ RelationshipGraph::RelationshipGraph(size_t reserve)
 
 void RelationshipGraph::registerUser(NodeID user)
 {
-    followsGraph.addNode(user);
+    if (followsGraph.addNode(user))
+    {
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        followsVersion++;
+        if (distanceOracle)
+            distanceOracle->nodeAdded();
+    }
     likesGraph.addNode(user);
     activeGraph.addNode(user);
 }
@@ -68,12 +79,24 @@ void RelationshipGraph::registerPost(NodeID post)
 
 bool RelationshipGraph::follow(NodeID follower, NodeID followee)
 {
-    return followsGraph.addEdge(follower, followee);
+    if (!followsGraph.addEdge(follower, followee))
+        return false;
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    followsVersion++;
+    if (distanceOracle)
+        distanceOracle->edgeAdded(followsGraph, follower, followee);
+    return true;
 }
 
 bool RelationshipGraph::unfollow(NodeID follower, NodeID followee)
 {
-    return followsGraph.removeEdge(follower, followee);
+    if (!followsGraph.removeEdge(follower, followee))
+        return false;
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    followsVersion++;
+    if (distanceOracle)
+        distanceOracle->edgeRemoved();
+    return true;
 }
 
 bool RelationshipGraph::isFollowing(NodeID follower, NodeID followee) const
@@ -81,12 +104,12 @@ bool RelationshipGraph::isFollowing(NodeID follower, NodeID followee) const
     return followsGraph.hasEdge(follower, followee);
 }
 
-const Set<NodeID> *RelationshipGraph::getFollowers(NodeID user) const
+const AdjacencySet *RelationshipGraph::getFollowers(NodeID user) const
 {
     return followsGraph.inNeighbors(user);
 }
 
-const Set<NodeID> *RelationshipGraph::getFollowing(NodeID user) const
+const AdjacencySet *RelationshipGraph::getFollowing(NodeID user) const
 {
     return followsGraph.outNeighbors(user);
 }
@@ -101,6 +124,74 @@ size_t RelationshipGraph::followingCount(NodeID user) const
     return followsGraph.outDegree(user);
 }
 
+void RelationshipGraph::compressUser(NodeID user)
+{
+    followsGraph.compressNode(user);
+}
+
+std::shared_ptr<const CSRGraph> RelationshipGraph::followsSnapshot() const
+{
+    {
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        if (followsCSR)
+            return followsCSR;
+    }
+
+    // Only the very first read builds; later ones wait for refreshSnapshots
+    auto csr = std::make_shared<const CSRGraph>(followsGraph.buildCSRSnapshot());
+    std::lock_guard<std::mutex> guard(snapshotMutex);
+    if (!followsCSR)
+    {
+        followsCSR = std::move(csr);
+        snapshotVersion = followsVersion;
+    }
+    return followsCSR;
+}
+
+std::shared_ptr<const CSRGraph> RelationshipGraph::likesSnapshot() const
+{
+    {
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        if (likesCSR)
+            return likesCSR;
+    }
+
+    auto csr = std::make_shared<const CSRGraph>(likesGraph.buildCSRSnapshot());
+    std::lock_guard<std::mutex> guard(snapshotMutex);
+    if (!likesCSR)
+    {
+        likesCSR = std::move(csr);
+        likesSnapshotVersion = likesVersion;
+    }
+    return likesCSR;
+}
+
+void RelationshipGraph::refreshSnapshots()
+{
+    bool followsStale, likesStale;
+    {
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        followsStale = !followsCSR || snapshotVersion != followsVersion;
+        likesStale = !likesCSR || likesSnapshotVersion != likesVersion;
+    }
+
+    // Built without the lock, so readers keep getting the old snapshots meanwhile
+    if (followsStale)
+    {
+        auto csr = std::make_shared<const CSRGraph>(followsGraph.buildCSRSnapshot());
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        followsCSR = std::move(csr);
+        snapshotVersion = followsVersion;
+    }
+    if (likesStale)
+    {
+        auto csr = std::make_shared<const CSRGraph>(likesGraph.buildCSRSnapshot());
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        likesCSR = std::move(csr);
+        likesSnapshotVersion = likesVersion;
+    }
+}
+
 // ============================================================================
 // Mutual Connections & Friends
 // ============================================================================
@@ -109,20 +200,13 @@ std::vector<NodeID> RelationshipGraph::getFriends(NodeID user) const
 {
     std::vector<NodeID> friends;
 
-    const Set<NodeID> *following = followsGraph.outNeighbors(user);
-    if (!following)
+    const AdjacencySet *following = followsGraph.outNeighbors(user);
+    const AdjacencySet *followers = followsGraph.inNeighbors(user);
+    if (!following || !followers)
         return friends;
 
-    auto &data = following->data();
-
-    for (size_t i = 0; i < following->size(); i++)
-    {
-        NodeID other = data[i];
-        if (followsGraph.hasEdge(other, user))
-        {
-            friends.push_back(other);
-        }
-    }
+    // Friends follow each other: following ∩ followers
+    following->intersect(*followers, friends);
     return friends;
 }
 
@@ -130,20 +214,13 @@ std::vector<NodeID> RelationshipGraph::getMutualConnections(NodeID user1, NodeID
 {
     std::vector<NodeID> mutuals;
 
-    const Set<NodeID> *following1 = followsGraph.outNeighbors(user1);
-    const Set<NodeID> *following2 = followsGraph.outNeighbors(user2);
+    const AdjacencySet *following1 = followsGraph.outNeighbors(user1);
+    const AdjacencySet *following2 = followsGraph.outNeighbors(user2);
 
     if (!following1 || !following2)
         return mutuals;
 
-    const auto &data = following1->data();
-
-    for (size_t i = 0; i < following1->size(); i++)
-    {
-        NodeID id = data[i];
-        if (following2->contains(id))
-            mutuals.push_back(id);
-    }
+    following1->intersect(*following2, mutuals);
     return mutuals;
 }
 
@@ -153,12 +230,20 @@ std::vector<NodeID> RelationshipGraph::getMutualConnections(NodeID user1, NodeID
 
 bool RelationshipGraph::likePost(NodeID user, NodeID post)
 {
-    return likesGraph.addEdge(user, post);
+    if (!likesGraph.addEdge(user, post))
+        return false;
+    likesVersion++;
+    interests.liked(user, post);
+    return true;
 }
 
 bool RelationshipGraph::unlikePost(NodeID user, NodeID post)
 {
-    return likesGraph.removeEdge(user, post);
+    if (!likesGraph.removeEdge(user, post))
+        return false;
+    likesVersion++;
+    interests.unliked(user, post, likesGraph.outNeighbors(user));
+    return true;
 }
 
 bool RelationshipGraph::hasLiked(NodeID user, NodeID post) const
@@ -166,7 +251,7 @@ bool RelationshipGraph::hasLiked(NodeID user, NodeID post) const
     return likesGraph.hasEdge(user, post);
 }
 
-const Set<NodeID> *RelationshipGraph::getPostLikes(NodeID post) const
+const AdjacencySet *RelationshipGraph::getPostLikes(NodeID post) const
 {
     return likesGraph.inNeighbors(post);
 }
@@ -204,7 +289,7 @@ void RelationshipGraph::expireActive(long long now)
     }
 }
 
-const Set<NodeID> *RelationshipGraph::getActiveWith(NodeID user) const
+const AdjacencySet *RelationshipGraph::getActiveWith(NodeID user) const
 {
     return activeGraph.outNeighbors(user);
 }
@@ -225,43 +310,86 @@ void RelationshipGraph::clearActive()
 
 void RelationshipGraph::bfsHelper(NodeID start, std::function<bool(NodeID, int)> visitor, int maxDepth) const
 {
-    Queue<std::pair<NodeID, int>> q;
-    Set<NodeID> visited;
+    // A depth-bounded search only touches the neighbourhood of start, so it
+    // walks the live graph with a sparse visited set rather than paying for a
+    // snapshot rebuild and an O(V) visited array after every write
+    if (maxDepth != -1)
+    {
+        Queue<std::pair<NodeID, int>> q;
+        Set<NodeID> visited;
 
-    q.enqueue({start, 0});
-    visited.insert(start);
+        q.enqueue({start, 0});
+        visited.insert(start);
 
-    while (!q.isEmpty())
-    {
-        auto current = q.front();
-        q.dequeue();
+        while (!q.isEmpty())
+        {
+            auto current = q.front();
+            q.dequeue();
 
-        NodeID node = current.first;
-        int depth = current.second;
+            NodeID node = current.first;
+            int depth = current.second;
 
-        // Call visitor; if it returns false, stop traversal
-        if (!visitor(node, depth))
-            return;
+            // Call visitor; if it returns false, stop traversal
+            if (!visitor(node, depth))
+                return;
 
-        // Check depth limit
-        if (maxDepth != -1 && depth >= maxDepth)
-            continue;
+            if (depth >= maxDepth)
+                continue;
 
-        // Visit neighbors
-        const Set<NodeID> *neighbors = followsGraph.outNeighbors(node);
-        if (!neighbors)
-            continue;
+            const AdjacencySet *neighbors = followsGraph.outNeighbors(node);
+            if (!neighbors)
+                continue;
+
+            for (NodeID neighbor : *neighbors)
+            {
+                if (visited.insert(neighbor))
+                    q.enqueue({neighbor, depth + 1});
+            }
+        }
+        return;
+    }
+
+    // Unbounded: the whole graph is in play anyway, so use the snapshot
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+
+    CSRGraph::DenseID source = csr->denseID(start);
+    if (source == CSRGraph::NONE)
+    {
+        visitor(start, 0);
+        return;
+    }
 
-        const auto &data = neighbors->data();
-        for (size_t i = 0; i < neighbors->size(); i++)
+    // Level by level over dense IDs; visit order matches a FIFO queue
+    std::vector<char> visited(csr->nodeCount(), 0);
+    std::vector<CSRGraph::DenseID> frontier{source};
+    std::vector<CSRGraph::DenseID> next;
+    visited[source] = 1;
+
+    for (int depth = 0; !frontier.empty(); depth++)
+    {
+        bool expand = maxDepth == -1 || depth < maxDepth;
+
+        for (CSRGraph::DenseID node : frontier)
         {
-            NodeID neighbor = data[i];
-            if (!visited.contains(neighbor))
+            // Call visitor; if it returns false, stop traversal
+            if (!visitor(csr->nodeID(node), depth))
+                return;
+
+            if (!expand)
+                continue;
+
+            for (CSRGraph::DenseID neighbor : csr->outNeighbors(node))
             {
-                visited.insert(neighbor);
-                q.enqueue({neighbor, depth + 1});
+                if (!visited[neighbor])
+                {
+                    visited[neighbor] = 1;
+                    next.push_back(neighbor);
+                }
             }
         }
+
+        frontier.swap(next);
+        next.clear();
     }
 }
 
@@ -273,25 +401,154 @@ void RelationshipGraph::bfs(NodeID start, std::function<bool(NodeID, int)> visit
 std::vector<NodeID> RelationshipGraph::getReachableUsers(NodeID start, int maxDepth) const
 {
     std::vector<NodeID> reachable;
-    bfsHelper(start, [&](NodeID node, int depth)
-              {
+    auto collect = [&](NodeID node, int depth)
+    {
         if (node != start)
             reachable.push_back(node);
-        return true; }, maxDepth);
+        return true;
+    };
+
+    // Only a whole-graph search is worth the snapshot and the thread pool
+    if (maxDepth == -1)
+        bfsParallel(start, maxDepth, collect);
+    else
+        bfsHelper(start, collect, maxDepth);
     return reachable;
 }
 
+// ============================================================================
+// Network Traversal - Parallel BFS
+// ============================================================================
+
+// Beamer's switch points: go bottom-up once the frontier's out-edges exceed
+// 1/BFS_ALPHA of the in-edges still unexplored, and back top-down once the
+// frontier holds under 1/BFS_BETA of all nodes
+static const size_t BFS_ALPHA = 14;
+static const size_t BFS_BETA = 24;
+
+static const size_t TOP_DOWN_GRAIN = 256;   // frontier nodes per task
+static const size_t BOTTOM_UP_GRAIN = 4096; // nodes per task; a multiple of 64
+
+// Claims node i in the shared visited bitmap; true for exactly one caller
+static bool claimNode(std::vector<std::atomic<uint64_t>> &visited, size_t i)
+{
+    uint64_t bit = 1ULL << (i % 64);
+    if (visited[i / 64].load(std::memory_order_relaxed) & bit)
+        return false;
+    return !(visited[i / 64].fetch_or(bit, std::memory_order_relaxed) & bit);
+}
+
+void RelationshipGraph::bfsParallel(NodeID start, int maxDepth, std::function<bool(NodeID, int)> visitor) const
+{
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+
+    CSRGraph::DenseID source = csr->denseID(start);
+    if (source == CSRGraph::NONE)
+    {
+        visitor(start, 0);
+        return;
+    }
+
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = csr->nodeCount();
+    size_t words = (n + 63) / 64;
+
+    std::vector<std::atomic<uint64_t>> visited(words);
+    std::vector<uint64_t> inFrontier;                        // bottom-up levels only
+    std::vector<std::vector<CSRGraph::DenseID>> discovered; // one list per task
+    std::vector<CSRGraph::DenseID> frontier{source};
+    claimNode(visited, source);
+
+    size_t unexploredEdges = csr->edgeCount() - csr->inDegree(source);
+    bool bottomUp = false;
+
+    for (int depth = 0; !frontier.empty(); depth++)
+    {
+        for (CSRGraph::DenseID node : frontier)
+        {
+            // Call visitor; if it returns false, stop traversal
+            if (!visitor(csr->nodeID(node), depth))
+                return;
+        }
+
+        if (maxDepth != -1 && depth >= maxDepth)
+            return;
+
+        size_t frontierEdges = 0;
+        for (CSRGraph::DenseID node : frontier)
+            frontierEdges += csr->outDegree(node);
+
+        if (!bottomUp && frontierEdges > unexploredEdges / BFS_ALPHA)
+            bottomUp = true;
+        else if (bottomUp && frontier.size() < n / BFS_BETA)
+            bottomUp = false;
+
+        if (!bottomUp)
+        {
+            // Top-down: each task expands a slice of the frontier, claiming
+            // unvisited out-neighbours
+            discovered.assign((frontier.size() + TOP_DOWN_GRAIN - 1) / TOP_DOWN_GRAIN, {});
+            pool.parallelFor(frontier.size(), TOP_DOWN_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                             {
+                std::vector<CSRGraph::DenseID> &out = discovered[chunk];
+                for (size_t i = begin; i < end; i++)
+                {
+                    for (CSRGraph::DenseID neighbor : csr->outNeighbors(frontier[i]))
+                    {
+                        if (claimNode(visited, neighbor))
+                            out.push_back(neighbor);
+                    }
+                } });
+        }
+        else
+        {
+            // Bottom-up: each task owns a range of nodes (whole bitmap words)
+            // and looks for any in-neighbour on the frontier
+            inFrontier.assign(words, 0);
+            for (CSRGraph::DenseID node : frontier)
+                inFrontier[node / 64] |= 1ULL << (node % 64);
+
+            discovered.assign((n + BOTTOM_UP_GRAIN - 1) / BOTTOM_UP_GRAIN, {});
+            pool.parallelFor(n, BOTTOM_UP_GRAIN, [&](size_t chunk, size_t begin, size_t end)
+                             {
+                std::vector<CSRGraph::DenseID> &out = discovered[chunk];
+                for (size_t node = begin; node < end; node++)
+                {
+                    if ((visited[node / 64].load(std::memory_order_relaxed) >> (node % 64)) & 1)
+                        continue;
+
+                    for (CSRGraph::DenseID parent : csr->inNeighbors(node))
+                    {
+                        if ((inFrontier[parent / 64] >> (parent % 64)) & 1)
+                        {
+                            visited[node / 64].fetch_or(1ULL << (node % 64), std::memory_order_relaxed);
+                            out.push_back(static_cast<CSRGraph::DenseID>(node));
+                            break;
+                        }
+                    }
+                } });
+        }
+
+        frontier.clear();
+        for (const std::vector<CSRGraph::DenseID> &part : discovered)
+            frontier.insert(frontier.end(), part.begin(), part.end());
+
+        for (CSRGraph::DenseID node : frontier)
+            unexploredEdges -= csr->inDegree(node);
+    }
+}
+
 // ============================================================================
 // Network Traversal - DFS
 // ============================================================================
 
-void RelationshipGraph::dfsHelper(NodeID current, HashMap<NodeID, bool> &visited,
+void RelationshipGraph::dfsHelper(const CSRGraph &csr, CSRGraph::DenseID current, std::vector<char> &visited,
                                   std::function<bool(NodeID, int)> visitor, int depth, int maxDepth) const
 {
-    visited.insert(current, true);
+    visited[current] = 1;
 
     // Call visitor; if it returns false, stop traversal
-    if (!visitor(current, depth))
+    if (!visitor(csr.nodeID(current), depth))
         return;
 
     // Check depth limit
@@ -299,16 +556,35 @@ void RelationshipGraph::dfsHelper(NodeID current, HashMap<NodeID, bool> &visited
         return;
 
     // Visit neighbors
-    const Set<NodeID> *neighbors = followsGraph.outNeighbors(current);
+    for (CSRGraph::DenseID neighbor : csr.outNeighbors(current))
+    {
+        if (!visited[neighbor])
+        {
+            dfsHelper(csr, neighbor, visited, visitor, depth + 1, maxDepth);
+        }
+    }
+}
+
+void RelationshipGraph::dfsHelper(NodeID current, Set<NodeID> &visited,
+                                  std::function<bool(NodeID, int)> visitor, int depth, int maxDepth) const
+{
+    visited.insert(current);
+
+    // Call visitor; if it returns false, stop traversal
+    if (!visitor(current, depth))
+        return;
+
+    // Check depth limit
+    if (depth >= maxDepth)
+        return;
+
+    const AdjacencySet *neighbors = followsGraph.outNeighbors(current);
     if (!neighbors)
         return;
 
-    const auto &data = neighbors->data();
-    for (size_t i = 0; i < neighbors->size(); i++)
+    for (NodeID neighbor : *neighbors)
     {
-        NodeID neighbor = data[i];
-        bool *isVisited = visited.get(neighbor);
-        if (!isVisited || !(*isVisited))
+        if (!visited.contains(neighbor))
         {
             dfsHelper(neighbor, visited, visitor, depth + 1, maxDepth);
         }
@@ -317,8 +593,25 @@ void RelationshipGraph::dfsHelper(NodeID current, HashMap<NodeID, bool> &visited
 
 void RelationshipGraph::dfs(NodeID start, std::function<bool(NodeID, int)> visitor, int maxDepth) const
 {
-    HashMap<NodeID, bool> visited;
-    dfsHelper(start, visited, visitor, 0, maxDepth);
+    // Depth-bounded: live graph and a sparse visited set, as in bfsHelper
+    if (maxDepth != -1)
+    {
+        Set<NodeID> visited;
+        dfsHelper(start, visited, visitor, 0, maxDepth);
+        return;
+    }
+
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+
+    CSRGraph::DenseID source = csr->denseID(start);
+    if (source == CSRGraph::NONE)
+    {
+        visitor(start, 0);
+        return;
+    }
+
+    std::vector<char> visited(csr->nodeCount(), 0);
+    dfsHelper(*csr, source, visited, visitor, 0, maxDepth);
 }
 
 // ============================================================================
@@ -331,13 +624,12 @@ std::vector<NodeID> RelationshipGraph::getFriendOfFriend(NodeID user, int maxDep
     Set<NodeID> directFriends;
 
     // Get direct friends (depth 1)
-    const Set<NodeID> *following = followsGraph.outNeighbors(user);
+    const AdjacencySet *following = followsGraph.outNeighbors(user);
     if (following)
     {
-        const auto &data = following->data();
-        for (size_t i = 0; i < following->size(); i++)
+        for (NodeID id : *following)
         {
-            directFriends.insert(data[i]);
+            directFriends.insert(id);
         }
     }
 
@@ -383,73 +675,111 @@ HashMap<NodeID, int> RelationshipGraph::getFoFWithDistance(NodeID user, int maxD
 // Graph-based Recommendation Heuristics
 // ============================================================================
 
+// The walk stops early once limit candidates have this many visits each:
+// their order has settled and further steps mostly refine the tail
+static const uint32_t WALK_WELL_SAMPLED = 32;
+// Visit multiplier for candidates in the user's own community
+static const double SAME_COMMUNITY_BOOST = 1.5;
+
 std::vector<RecommendationScore> RelationshipGraph::recommendUsers(NodeID user, size_t limit) const
 {
-    // Combined recommendation strategy
-    HashMap<NodeID, double> scores;
-    HashMap<NodeID, std::string> reasons;
+    return recommendByRandomWalk(user, limit);
+}
+
+std::vector<RecommendationScore> RelationshipGraph::recommendByRandomWalk(NodeID user, size_t limit, size_t steps,
+                                                                          double restartProbability) const
+{
+    const AdjacencySet *alreadyFollowing = followsGraph.outNeighbors(user);
+    if (!alreadyFollowing || limit == 0)
+        return {};
 
-    // 1. Friend-of-Friend (weight: 0.4)
-    auto fofDist = getFoFWithDistance(user, 2);
-    for (auto it = fofDist.begin(); it != fofDist.end(); ++it)
+    // Per visited user
+    struct Visits
     {
-        NodeID fof = (*it).key;
-        int dist = (*it).value;
+        uint32_t viaFollows = 0;
+        uint32_t viaLikes = 0;
+        bool excluded = false; // already followed
+    };
+    HashMap<NodeID, Visits> visits;
+
+    std::mt19937_64 rng(user);
+    std::bernoulli_distribution restart(restartProbability);
+
+    NodeID current = user;
+    size_t wellSampled = 0;
 
-        if (!isFollowing(user, fof))
+    for (size_t step = 0; step < steps && wellSampled < limit; step++)
+    {
+        if (current != user && restart(rng))
         {
-            scores.insert(fof, 0.4 / dist);
-            reasons.insert(fof, "Friend of friend");
+            current = user;
+            continue;
         }
-    }
 
-    // 2. Mutual friends (weight: 0.35)
-    const Set<NodeID> *following = followsGraph.outNeighbors(user);
-    if (following)
-    {
-        const auto &data = following->data();
-        for (size_t i = 0; i < following->size(); i++)
+        const AdjacencySet *followees = followsGraph.outNeighbors(current);
+        const AdjacencySet *liked = likesGraph.outNeighbors(current);
+        size_t followCount = followees ? followees->size() : 0;
+        size_t likeCount = liked ? liked->size() : 0;
+
+        size_t choices = followCount + likeCount;
+        if (choices == 0)
         {
-            NodeID friend_id = data[i];
-            const Set<NodeID> *friendFollowing = followsGraph.outNeighbors(friend_id);
-            if (friendFollowing)
+            current = user;
+            continue;
+        }
+
+        // One uniform pick over follow and like edges together
+        size_t pick = rng() % choices;
+        bool viaLikes = pick >= followCount;
+        NodeID next;
+        if (!viaLikes)
+        {
+            next = followees->at(pick);
+        }
+        else
+        {
+            // Never empty: the current user is one of the likers
+            const AdjacencySet *likers = likesGraph.inNeighbors(liked->at(pick - followCount));
+            next = likers->at(rng() % likers->size());
+            if (!followsGraph.outNeighbors(next))
             {
-                const auto &friendData = friendFollowing->data();
-                for (size_t j = 0; j < friendFollowing->size(); j++)
-                {
-                    NodeID candidate = friendData[j];
-                    if (candidate != user && !isFollowing(user, candidate))
-                    {
-                        double *currentScore = scores.get(candidate);
-                        if (currentScore)
-                            scores[candidate] = *currentScore + 0.35;
-                        else
-                            scores.insert(candidate, 0.35);
-
-                        if (!reasons.contains(candidate))
-                            reasons.insert(candidate, "Mutual connections");
-                    }
-                }
+                current = user;
+                continue;
             }
         }
-    }
 
-    // 3. Popularity (weight: 0.25)
-    for (auto it = scores.begin(); it != scores.end(); ++it)
-    {
-        NodeID candidate = (*it).key;
-        size_t followers = followerCount(candidate);
-        scores[candidate] = (*it).value + 0.25 * std::log(followers + 1) / 10.0;
+        current = next;
+        if (next == user)
+            continue;
+
+        auto slot = visits.try_emplace(next);
+        Visits &v = *slot.first;
+        if (slot.second)
+            v.excluded = alreadyFollowing->contains(next);
+        if (v.excluded)
+            continue;
+
+        (viaLikes ? v.viaLikes : v.viaFollows)++;
+        if (v.viaFollows + v.viaLikes == WALK_WELL_SAMPLED)
+            wellSampled++;
     }
 
-    // Convert to vector and sort
+    std::shared_ptr<const Communities> partition = communityPartition();
+    uint32_t home = partition ? partition->communityOf(user) : Communities::NONE;
+
     std::vector<RecommendationScore> recommendations;
-    for (auto it = scores.begin(); it != scores.end(); ++it)
+    for (auto it = visits.begin(); it != visits.end(); ++it)
     {
-        NodeID uid = (*it).key;
-        double score = (*it).value;
-        std::string *reason = reasons.get(uid);
-        recommendations.push_back({uid, score, reason ? *reason : ""});
+        const Visits &v = (*it).value;
+        if (v.excluded)
+            continue;
+
+        NodeID candidate = (*it).key;
+        double score = static_cast<double>(v.viaFollows + v.viaLikes);
+        if (home != Communities::NONE && partition->communityOf(candidate) == home)
+            score *= SAME_COMMUNITY_BOOST;
+
+        recommendations.push_back({candidate, score, v.viaFollows >= v.viaLikes ? "Friend of friend" : "Similar likes"});
     }
 
     customSort(recommendations, [](const RecommendationScore &a, const RecommendationScore &b)
@@ -465,22 +795,18 @@ std::vector<RecommendationScore> RelationshipGraph::recommendByMutualFriends(Nod
 {
     HashMap<NodeID, int> mutualCount;
 
-    const Set<NodeID> *following = followsGraph.outNeighbors(user);
+    const AdjacencySet *following = followsGraph.outNeighbors(user);
     if (!following)
         return {};
 
-    const auto &data = following->data();
-    for (size_t i = 0; i < following->size(); i++)
+    for (NodeID friend_id : *following)
     {
-        NodeID friend_id = data[i];
-        const Set<NodeID> *friendFollowing = followsGraph.outNeighbors(friend_id);
+        const AdjacencySet *friendFollowing = followsGraph.outNeighbors(friend_id);
         if (!friendFollowing)
             continue;
 
-        const auto &friendData = friendFollowing->data();
-        for (size_t j = 0; j < friendFollowing->size(); j++)
+        for (NodeID candidate : *friendFollowing)
         {
-            NodeID candidate = friendData[j];
             if (candidate != user && !isFollowing(user, candidate))
             {
                 int *count = mutualCount.get(candidate);
@@ -512,51 +838,21 @@ std::vector<RecommendationScore> RelationshipGraph::recommendByMutualFriends(Nod
 
 std::vector<RecommendationScore> RelationshipGraph::recommendByCommonInterests(NodeID user, size_t limit) const
 {
-    HashMap<NodeID, int> commonInterests;
-
-    // Get posts liked by user
-    const Set<NodeID> *userLikes = likesGraph.outNeighbors(user);
-    if (!userLikes)
-        return {};
+    std::vector<RecommendationScore> recommendations;
 
-    const auto &likedPosts = userLikes->data();
-    for (size_t i = 0; i < userLikes->size(); i++)
+    // Already ranked by similarity; take the best not yet followed
+    for (const auto &match : interests.similarUsers(user))
     {
-        NodeID post = likedPosts[i];
-        const Set<NodeID> *postLikers = likesGraph.inNeighbors(post);
-        if (!postLikers)
+        if (recommendations.size() == limit)
+            break;
+        if (isFollowing(user, match.first))
             continue;
 
-        const auto &likers = postLikers->data();
-        for (size_t j = 0; j < postLikers->size(); j++)
-        {
-            NodeID candidate = likers[j];
-            if (candidate != user && !isFollowing(user, candidate))
-            {
-                int *count = commonInterests.get(candidate);
-                if (count)
-                    commonInterests.insert(candidate, *count + 1);
-                else
-                    commonInterests.insert(candidate, 1);
-            }
-        }
-    }
-
-    std::vector<RecommendationScore> recommendations;
-    for (auto it = commonInterests.begin(); it != commonInterests.end(); ++it)
-    {
-        NodeID uid = (*it).key;
-        int count = (*it).value;
-        recommendations.push_back({uid, static_cast<double>(count),
-                                   std::to_string(count) + " common interest(s)"});
+        int percent = static_cast<int>(std::lround(match.second * 100.0));
+        recommendations.push_back({match.first, match.second,
+                                   std::to_string(percent) + "% similar likes"});
     }
 
-    customSort(recommendations, [](const RecommendationScore &a, const RecommendationScore &b)
-               { return a.score > b.score; });
-
-    if (recommendations.size() > limit)
-        recommendations.resize(limit);
-
     return recommendations;
 }
 
@@ -566,14 +862,17 @@ std::vector<RecommendationScore> RelationshipGraph::recommendByPopularity(NodeID
 
     // Get all users via FoF or traversal
     auto fofUsers = getFriendOfFriend(user, 3);
+    std::shared_ptr<const PageRank> ranks = influenceScores();
 
     for (size_t i = 0; i < fofUsers.size(); i++)
     {
         NodeID candidate = fofUsers[i];
         if (!isFollowing(user, candidate))
         {
-            size_t followers = followerCount(candidate);
-            recommendations.push_back({candidate, static_cast<double>(followers),
+            size_t followers = followsGraph.inDegree(candidate);
+            // Rank by influence once computed: follower count alone rewards follow-spam
+            double score = ranks ? ranks->relativeScore(candidate) : static_cast<double>(followers);
+            recommendations.push_back({candidate, score,
                                        std::to_string(followers) + " follower(s)"});
         }
     }
@@ -587,56 +886,382 @@ std::vector<RecommendationScore> RelationshipGraph::recommendByPopularity(NodeID
     return recommendations;
 }
 
+// ============================================================================
+// Influence
+// ============================================================================
+
+void RelationshipGraph::refreshInfluenceScores(const PageRankOptions &options)
+{
+    refreshSnapshots();
+    auto ranks = std::make_shared<const PageRank>(followsSnapshot(), options);
+
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    influence = std::move(ranks);
+}
+
+bool RelationshipGraph::startInfluenceRefresh(const PageRankOptions &options)
+{
+    if (influenceJob.valid())
+    {
+        if (influenceJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        influenceJob.get();
+    }
+
+    // Snapshot taken here, so the job never reads the live graph
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    influenceJob = std::async(std::launch::async, [this, csr, options]()
+                              {
+        auto ranks = std::make_shared<const PageRank>(csr, options);
+
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        influence = std::move(ranks); });
+    return true;
+}
+
+double RelationshipGraph::getInfluenceScore(NodeID user) const
+{
+    std::shared_ptr<const PageRank> ranks = influenceScores();
+    return ranks ? ranks->relativeScore(user) : 0.0;
+}
+
+std::shared_ptr<const PageRank> RelationshipGraph::influenceScores() const
+{
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    return influence;
+}
+
+void RelationshipGraph::startStaleRefreshes()
+{
+    // Every follows change gets a new snapshot here, so a result is current
+    // exactly when it shares that snapshot's node index
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph::NodeIndex> current = followsSnapshot()->nodeIndex();
+
+    std::shared_ptr<const PageRank> ranks = influenceScores();
+    if (!ranks || ranks->nodeIndex() != current)
+        startInfluenceRefresh();
+
+    std::shared_ptr<const Communities> partition = communityPartition();
+    if (!partition || partition->nodeIndex() != current)
+        startCommunityRefresh();
+
+    std::shared_ptr<const ReachSketches> sketches = reachSketches();
+    if (!sketches || sketches->nodeIndex() != current)
+        startReachRefresh();
+
+    // The oracle folds in new follows itself; it is stale only once it has
+    // missed changes
+    bool oracleStale;
+    {
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        oracleStale = !distanceOracle || distanceOracle->needsRebuild();
+    }
+    if (oracleStale)
+        startDistanceOracleRefresh(oracleLandmarks);
+}
+
+// ============================================================================
+// Communities
+// ============================================================================
+
+void RelationshipGraph::refreshCommunities(const LabelPropagationOptions &options)
+{
+    refreshSnapshots();
+    auto partition = std::make_shared<const Communities>(followsSnapshot(), options);
+
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    communities = std::move(partition);
+}
+
+bool RelationshipGraph::startCommunityRefresh(const LabelPropagationOptions &options)
+{
+    if (communityJob.valid())
+    {
+        if (communityJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        communityJob.get();
+    }
+
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    communityJob = std::async(std::launch::async, [this, csr, options]()
+                              {
+        auto partition = std::make_shared<const Communities>(csr, options);
+
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        communities = std::move(partition); });
+    return true;
+}
+
+uint32_t RelationshipGraph::getCommunity(NodeID user) const
+{
+    std::shared_ptr<const Communities> partition = communityPartition();
+    return partition ? partition->communityOf(user) : Communities::NONE;
+}
+
+std::shared_ptr<const Communities> RelationshipGraph::communityPartition() const
+{
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    return communities;
+}
+
+// ============================================================================
+// Reach Estimates
+// ============================================================================
+
+void RelationshipGraph::refreshReachEstimates(size_t registers)
+{
+    refreshSnapshots();
+    auto sketches = std::make_shared<const ReachSketches>(followsSnapshot(), registers);
+
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    reach = std::move(sketches);
+}
+
+bool RelationshipGraph::startReachRefresh(size_t registers)
+{
+    if (reachJob.valid())
+    {
+        if (reachJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        reachJob.get();
+    }
+
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    reachJob = std::async(std::launch::async, [this, csr, registers]()
+                          {
+        auto sketches = std::make_shared<const ReachSketches>(csr, registers);
+
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        reach = std::move(sketches); });
+    return true;
+}
+
+double RelationshipGraph::estimateReach(NodeID user, int hops) const
+{
+    std::shared_ptr<const ReachSketches> sketches = reachSketches();
+    double estimate = sketches ? sketches->estimate(user, hops) : -1.0;
+    if (estimate >= 0.0)
+        return estimate;
+
+    return static_cast<double>(getReachableUsers(user, hops).size());
+}
+
+std::shared_ptr<const ReachSketches> RelationshipGraph::reachSketches() const
+{
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    return reach;
+}
+
 // ============================================================================
 // Cycle Detection
 // ============================================================================
 
+HashMap<NodeID, size_t> RelationshipGraph::getComponentIDs() const
+{
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    std::vector<uint32_t> component;
+    csr->stronglyConnectedComponents(component);
+
+    HashMap<NodeID, size_t> ids;
+    ids.reserve(component.size());
+    for (size_t d = 0; d < component.size(); d++)
+        ids.insert(csr->nodeID(static_cast<CSRGraph::DenseID>(d)), component[d]);
+    return ids;
+}
+
 bool RelationshipGraph::hasCycle() const
 {
-    HashMap<NodeID, int> state; // 0 = unvisited, 1 = visiting, 2 = visited
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    std::vector<uint32_t> component;
+    size_t count = csr->stronglyConnectedComponents(component);
 
-    std::function<bool(NodeID)> dfsCheckCycle = [&](NodeID node) -> bool
+    // A cycle is a component with two or more members, or a self-follow
+    if (count < csr->nodeCount())
+        return true;
+
+    for (size_t d = 0; d < csr->nodeCount(); d++)
+    {
+        for (CSRGraph::DenseID neighbor : csr->outNeighbors(static_cast<CSRGraph::DenseID>(d)))
+        {
+            if (neighbor == d)
+                return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::vector<NodeID>> RelationshipGraph::findAllCycles(size_t maxCycles, size_t maxLength) const
+{
+    std::vector<std::vector<NodeID>> cycles;
+    if (maxCycles == 0)
+        return cycles;
+
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    size_t n = csr->nodeCount();
+
+    // Self-follows are the one-node cycles; the search below skips them
+    for (size_t d = 0; d < n && cycles.size() < maxCycles; d++)
+    {
+        CSRGraph::DenseID node = static_cast<CSRGraph::DenseID>(d);
+        for (CSRGraph::DenseID neighbor : csr->outNeighbors(node))
+        {
+            if (neighbor == node)
+                cycles.push_back({csr->nodeID(node)});
+        }
+    }
+    if (maxLength == 1 || cycles.size() >= maxCycles)
+        return cycles;
+
+    std::vector<uint32_t> component;
+    size_t count = csr->stronglyConnectedComponents(component);
+
+    // Johnson: every cycle lies inside one strongly connected component.
+    // Take a component, list the cycles through its smallest member, drop
+    // that member and push whatever components remain of the rest.
+    std::vector<std::vector<CSRGraph::DenseID>> work(count);
+    for (size_t d = 0; d < n; d++)
+        work[component[d]].push_back(static_cast<CSRGraph::DenseID>(d));
+    work.erase(std::remove_if(work.begin(), work.end(), [](const std::vector<CSRGraph::DenseID> &c)
+                              { return c.size() < 2; }),
+               work.end());
+
+    std::vector<char> inside(n, 0);
+    std::vector<char> blocked(n, 0);
+    std::vector<std::vector<CSRGraph::DenseID>> blockedBy(n); // Johnson's B lists
+    std::vector<CSRGraph::DenseID> path;
+    std::vector<CSRGraph::DenseID> unblockStack;
+
+    struct Frame
     {
-        state.insert(node, 1); // Mark as visiting
+        CSRGraph::DenseID node;
+        const CSRGraph::DenseID *next; // next out-edge to try
+        bool closed;                   // some path from here got back to the start
+    };
+    std::vector<Frame> calls;
+
+    auto unblock = [&](CSRGraph::DenseID node)
+    {
+        unblockStack.push_back(node);
+        while (!unblockStack.empty())
+        {
+            CSRGraph::DenseID u = unblockStack.back();
+            unblockStack.pop_back();
+            if (!blocked[u])
+                continue;
+
+            blocked[u] = 0;
+            unblockStack.insert(unblockStack.end(), blockedBy[u].begin(), blockedBy[u].end());
+            blockedBy[u].clear();
+        }
+    };
+
+    while (!work.empty())
+    {
+        std::vector<CSRGraph::DenseID> nodes = std::move(work.back());
+        work.pop_back();
 
-        const Set<NodeID> *neighbors = followsGraph.outNeighbors(node);
-        if (neighbors)
+        CSRGraph::DenseID start = nodes.front(); // members are ascending
+        for (CSRGraph::DenseID node : nodes)
         {
-            const auto &data = neighbors->data();
-            for (size_t i = 0; i < neighbors->size(); i++)
+            inside[node] = 1;
+            blocked[node] = 0;
+            blockedBy[node].clear();
+        }
+
+        blocked[start] = 1;
+        path.assign(1, start);
+        calls.push_back({start, csr->outNeighbors(start).begin(), false});
+
+        while (!calls.empty())
+        {
+            Frame &f = calls.back();
+            CSRGraph::DenseID v = f.node;
+
+            if (f.next != csr->outNeighbors(v).end())
             {
-                NodeID neighbor = data[i];
+                CSRGraph::DenseID w = *f.next++;
+                if (!inside[w] || w == v)
+                    continue;
 
-                auto it = state.find(neighbor);
-                if (it != state.end())
+                if (w == start)
                 {
-                    int neighborState = (*it).value;
-                    if (neighborState == 1)
-                        return true; // Back edge found - cycle detected
+                    std::vector<NodeID> cycle;
+                    cycle.reserve(path.size());
+                    for (CSRGraph::DenseID node : path)
+                        cycle.push_back(csr->nodeID(node));
+                    cycles.push_back(std::move(cycle));
+                    f.closed = true;
+
+                    if (cycles.size() >= maxCycles)
+                        return cycles;
                 }
-                else if (dfsCheckCycle(neighbor))
+                else if (!blocked[w])
                 {
-                    return true;
+                    // Cut off by the length limit: count as closed so v
+                    // stays reachable for shorter paths
+                    if (maxLength && path.size() >= maxLength)
+                    {
+                        f.closed = true;
+                        continue;
+                    }
+
+                    blocked[w] = 1;
+                    path.push_back(w);
+                    calls.push_back({w, csr->outNeighbors(w).begin(), false}); // f is invalid from here
                 }
+                continue;
             }
-        }
 
-        state[node] = 2; // Mark as visited
-        return false;
-    };
+            // Every edge of v tried
+            bool closed = f.closed;
+            if (closed)
+            {
+                unblock(v);
+            }
+            else
+            {
+                // Stay blocked until a successor is unblocked
+                for (CSRGraph::DenseID w : csr->outNeighbors(v))
+                {
+                    if (!inside[w] || w == v)
+                        continue;
 
-    // Check all nodes (for disconnected components)
-    // Note: This is a simplified version. In practice, you'd iterate through all nodes
-    // This would require access to all node IDs from the graph
+                    std::vector<CSRGraph::DenseID> &list = blockedBy[w];
+                    if (std::find(list.begin(), list.end(), v) == list.end())
+                        list.push_back(v);
+                }
+            }
 
-    return false; // Placeholder - requires node enumeration
-}
+            calls.pop_back();
+            path.pop_back();
+            if (closed && !calls.empty())
+                calls.back().closed = true;
+        }
 
-std::vector<std::vector<NodeID>> RelationshipGraph::findAllCycles() const
-{
-    // Placeholder for cycle finding algorithm (e.g., Johnson's algorithm)
-    // This is complex and would require significant implementation
-    return {};
+        // Components of what is left once start is gone
+        inside[start] = 0;
+        nodes.erase(nodes.begin());
+        size_t parts = csr->stronglyConnectedComponents(nodes, [&](CSRGraph::DenseID d)
+                                                        { return inside[d] != 0; }, component);
+
+        std::vector<std::vector<CSRGraph::DenseID>> split(parts);
+        for (CSRGraph::DenseID node : nodes)
+        {
+            split[component[node]].push_back(node);
+            inside[node] = 0;
+        }
+        for (std::vector<CSRGraph::DenseID> &part : split)
+        {
+            if (part.size() >= 2)
+                work.push_back(std::move(part));
+        }
+    }
+
+    return cycles;
 }
 
 // ============================================================================
@@ -645,67 +1270,443 @@ std::vector<std::vector<NodeID>> RelationshipGraph::findAllCycles() const
 
 double RelationshipGraph::getClusteringCoefficient(NodeID user) const
 {
-    const Set<NodeID> *neighbors = followsGraph.outNeighbors(user);
+    const AdjacencySet *neighbors = followsGraph.outNeighbors(user);
     if (!neighbors || neighbors->size() < 2)
         return 0.0;
 
-    const auto &data = neighbors->data();
-    int connections = 0;
-    int possibleConnections = 0;
+    // A neighbour pair counts once whichever way the edge points. Per neighbour
+    // n, its linked neighbours are (out(n) ∪ in(n)) ∩ N, sized by inclusion-
+    // exclusion from merge intersections; summing over n counts each pair twice.
+    size_t linkedEnds = 0;
+    std::vector<NodeID> outInN;
 
-    for (size_t i = 0; i < neighbors->size(); i++)
+    for (NodeID n : *neighbors)
     {
-        for (size_t j = i + 1; j < neighbors->size(); j++)
+        const AdjacencySet *out = followsGraph.outNeighbors(n);
+        const AdjacencySet *in = followsGraph.inNeighbors(n);
+        if (!out || !in)
+            continue;
+
+        out->intersect(*neighbors, outInN);
+        size_t both = 0;
+        for (NodeID m : outInN)
         {
-            possibleConnections++;
-            if (followsGraph.hasEdge(data[i], data[j]) ||
-                followsGraph.hasEdge(data[j], data[i]))
+            if (in->contains(m))
+                both++;
+        }
+
+        size_t linked = outInN.size() + in->intersectionSize(*neighbors) - both;
+        if (out->contains(n) && neighbors->contains(n))
+            linked--; // a self-loop is not a pair
+        linkedEnds += linked;
+    }
+
+    size_t k = neighbors->size();
+    double possibleConnections = k * (k - 1) / 2.0;
+    return (linkedEnds / 2) / possibleConnections;
+}
+
+// How many IDs two ascending ranges share. Gallops (binary searches) through
+// the longer one when the shorter is much smaller.
+static size_t countCommon(CSRGraph::Range a, CSRGraph::Range b)
+{
+    if (a.size() > b.size())
+        std::swap(a, b);
+
+    size_t common = 0;
+    if (a.size() * 16 < b.size())
+    {
+        const CSRGraph::DenseID *lo = b.begin();
+        for (CSRGraph::DenseID id : a)
+        {
+            lo = std::lower_bound(lo, b.end(), id);
+            if (lo == b.end())
+                break;
+            common += *lo == id;
+        }
+        return common;
+    }
+
+    const CSRGraph::DenseID *i = a.begin(), *j = b.begin();
+    while (i != a.end() && j != b.end())
+    {
+        if (*i < *j)
+            i++;
+        else if (*j < *i)
+            j++;
+        else
+        {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    return common;
+}
+
+// Every user's clustering coefficient, plus the global one, on one snapshot
+static std::shared_ptr<const ClusteringStats> computeClustering(const std::shared_ptr<const CSRGraph> &csr)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    size_t n = csr->nodeCount();
+    const size_t GRAIN = 1024;
+
+    // Rank nodes by total degree (ties by ID) and keep, per node, only the
+    // linked nodes ranked above it. Each link is then stored once, at its
+    // lower-degree end, so even a celebrity's list stays short.
+    std::vector<CSRGraph::DenseID> byDegree(n);
+    for (size_t d = 0; d < n; d++)
+        byDegree[d] = static_cast<CSRGraph::DenseID>(d);
+    std::sort(byDegree.begin(), byDegree.end(), [&](CSRGraph::DenseID a, CSRGraph::DenseID b)
+              {
+        size_t da = csr->outDegree(a) + csr->inDegree(a);
+        size_t db = csr->outDegree(b) + csr->inDegree(b);
+        return da != db ? da < db : a < b; });
+
+    std::vector<uint32_t> rank(n);
+    for (size_t r = 0; r < n; r++)
+        rank[byDegree[r]] = static_cast<uint32_t>(r);
+
+    // out ∪ in above a's rank, ascending by dense ID; with out == nullptr only counts
+    auto upperLinks = [&](CSRGraph::DenseID a, CSRGraph::DenseID *out)
+    {
+        CSRGraph::Range o = csr->outNeighbors(a), in = csr->inNeighbors(a);
+        const CSRGraph::DenseID *i = o.begin(), *j = in.begin();
+        size_t count = 0;
+        while (i != o.end() || j != in.end())
+        {
+            CSRGraph::DenseID next;
+            if (j == in.end() || (i != o.end() && *i < *j))
+                next = *i++;
+            else if (i == o.end() || *j < *i)
+                next = *j++;
+            else
             {
-                connections++;
+                next = *i++;
+                j++;
+            }
+
+            if (next != a && rank[next] > rank[a])
+            {
+                if (out)
+                    out[count] = next;
+                count++;
             }
         }
+        return count;
+    };
+
+    std::vector<size_t> upperOffsets(n + 1, 0);
+    pool.parallelFor(n, GRAIN, [&](size_t, size_t begin, size_t end)
+                     {
+        for (size_t a = begin; a < end; a++)
+            upperOffsets[a + 1] = upperLinks(static_cast<CSRGraph::DenseID>(a), nullptr); });
+    for (size_t a = 0; a < n; a++)
+        upperOffsets[a + 1] += upperOffsets[a];
+
+    std::vector<CSRGraph::DenseID> upperTargets(upperOffsets[n]);
+    pool.parallelFor(n, GRAIN, [&](size_t, size_t begin, size_t end)
+                     {
+        for (size_t a = begin; a < end; a++)
+            upperLinks(static_cast<CSRGraph::DenseID>(a), upperTargets.data() + upperOffsets[a]); });
+
+    // A pair of u's followees is linked iff one appears in the other's
+    // upper list, and exactly one of them holds it
+    std::vector<size_t> linkedPairs(n, 0);
+    pool.parallelFor(n, GRAIN, [&](size_t, size_t begin, size_t end)
+                     {
+        for (size_t u = begin; u < end; u++)
+        {
+            CSRGraph::Range following = csr->outNeighbors(static_cast<CSRGraph::DenseID>(u));
+            if (following.size() < 2)
+                continue;
+
+            size_t linked = 0;
+            for (CSRGraph::DenseID a : following)
+            {
+                CSRGraph::Range upper{upperTargets.data() + upperOffsets[a], upperTargets.data() + upperOffsets[a + 1]};
+                linked += countCommon(upper, following);
+            }
+            linkedPairs[u] = linked;
+        } });
+
+    auto stats = std::make_shared<ClusteringStats>();
+    stats->coefficients.reserve(n);
+    double linkedTotal = 0.0, possibleTotal = 0.0;
+
+    for (size_t u = 0; u < n; u++)
+    {
+        size_t k = csr->outDegree(static_cast<CSRGraph::DenseID>(u));
+        double possible = k * (k - 1) / 2.0;
+        stats->coefficients.insert(csr->nodeID(static_cast<CSRGraph::DenseID>(u)),
+                                   k < 2 ? 0.0 : linkedPairs[u] / possible);
+
+        if (k >= 2)
+        {
+            linkedTotal += linkedPairs[u];
+            possibleTotal += possible;
+        }
     }
+    stats->global = possibleTotal > 0 ? linkedTotal / possibleTotal : 0.0;
+    return stats;
+}
+
+void RelationshipGraph::refreshClusteringStats()
+{
+    refreshSnapshots();
+    std::shared_ptr<const ClusteringStats> stats = computeClustering(followsSnapshot());
 
-    return possibleConnections > 0 ? static_cast<double>(connections) / possibleConnections : 0.0;
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    clustering = std::move(stats);
 }
 
-int RelationshipGraph::getShortestPathLength(NodeID from, NodeID to) const
+bool RelationshipGraph::startClusteringRefresh()
 {
-    if (from == to)
-        return 0;
+    if (clusteringJob.valid())
+    {
+        if (clusteringJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        clusteringJob.get();
+    }
 
-    Queue<std::pair<NodeID, int>> q;
-    Set<NodeID> visited;
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    clusteringJob = std::async(std::launch::async, [this, csr]()
+                               {
+        std::shared_ptr<const ClusteringStats> stats = computeClustering(csr);
 
-    q.enqueue({from, 0});
-    visited.insert(from);
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        clustering = std::move(stats); });
+    return true;
+}
 
-    while (!q.isEmpty())
-    {
-        auto current = q.front();
-        q.dequeue();
+std::shared_ptr<const ClusteringStats> RelationshipGraph::clusteringStats() const
+{
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    return clustering;
+}
 
-        NodeID node = current.first;
-        int dist = current.second;
+double RelationshipGraph::getCachedClusteringCoefficient(NodeID user) const
+{
+    std::shared_ptr<const ClusteringStats> stats = clusteringStats();
+    const double *c = stats ? stats->coefficients.get(user) : nullptr;
+    return c ? *c : getClusteringCoefficient(user);
+}
 
-        const Set<NodeID> *neighbors = followsGraph.outNeighbors(node);
-        if (!neighbors)
+double RelationshipGraph::getGlobalClusteringCoefficient() const
+{
+    std::shared_ptr<const ClusteringStats> stats = clusteringStats();
+    if (stats)
+        return stats->global;
+
+    // No refresh yet: the same ratio, from each user's live coefficient
+    double linkedTotal = 0.0, possibleTotal = 0.0;
+    for (NodeID user : followsGraph.nodes())
+    {
+        size_t k = followsGraph.outDegree(user);
+        if (k < 2)
             continue;
 
-        const auto &data = neighbors->data();
-        for (size_t i = 0; i < neighbors->size(); i++)
+        double possible = k * (k - 1) / 2.0;
+        linkedTotal += getClusteringCoefficient(user) * possible;
+        possibleTotal += possible;
+    }
+    return possibleTotal > 0 ? linkedTotal / possibleTotal : 0.0;
+}
+
+// Bidirectional shortest-path search over the live follows graph: out-edges
+// from the source side, in-edges from the target side, one whole level at a
+// time on whichever side has fewer edges to scan. The first level that meets
+// the other side holds a shortest path. Distances are kept only for users
+// reached, so a query costs about the two neighbourhoods it explores.
+static int searchBothEnds(const Graph &g, NodeID source, NodeID target, int maxDepth)
+{
+    if (source == target)
+        return 0;
+
+    HashMap<NodeID, int> forwardDist, backwardDist;
+    forwardDist.insert(source, 0);
+    backwardDist.insert(target, 0);
+    std::vector<NodeID> forward{source}, backward{target}, next;
+    int forwardDepth = 0, backwardDepth = 0;
+
+    while (!forward.empty() && !backward.empty())
+    {
+        if (maxDepth != -1 && forwardDepth + backwardDepth >= maxDepth)
+            return -1;
+
+        size_t forwardEdges = 0, backwardEdges = 0;
+        for (NodeID node : forward)
+            forwardEdges += g.outDegree(node);
+        for (NodeID node : backward)
+            backwardEdges += g.inDegree(node);
+
+        bool fromSource = forwardEdges <= backwardEdges;
+        std::vector<NodeID> &frontier = fromSource ? forward : backward;
+        HashMap<NodeID, int> &reached = fromSource ? forwardDist : backwardDist;
+        const HashMap<NodeID, int> &otherSide = fromSource ? backwardDist : forwardDist;
+        int depth = fromSource ? forwardDepth : backwardDepth;
+
+        int best = -1;
+        next.clear();
+        for (NodeID node : frontier)
         {
-            NodeID neighbor = data[i];
-            if (neighbor == to)
-                return dist + 1;
+            const AdjacencySet *neighbors = fromSource ? g.outNeighbors(node) : g.inNeighbors(node);
+            if (!neighbors)
+                continue;
 
-            if (!visited.contains(neighbor))
+            for (NodeID neighbor : *neighbors)
             {
-                visited.insert(neighbor);
-                q.enqueue({neighbor, dist + 1});
+                const int *met = otherSide.get(neighbor);
+                if (met)
+                {
+                    int length = depth + 1 + *met;
+                    if (best == -1 || length < best)
+                        best = length;
+                }
+                if (reached.try_emplace(neighbor, depth + 1).second)
+                    next.push_back(neighbor);
             }
         }
+
+        frontier.swap(next);
+        (fromSource ? forwardDepth : backwardDepth)++;
+
+        if (best != -1)
+            return best;
     }
 
     return -1; // No path found
-}
\ No newline at end of file
+}
+
+int RelationshipGraph::getShortestPathLength(NodeID from, NodeID to, int maxDepth) const
+{
+    if (from == to)
+        return 0;
+    if (!followsGraph.outNeighbors(from) || !followsGraph.outNeighbors(to))
+        return -1;
+
+    return searchBothEnds(followsGraph, from, to, maxDepth);
+}
+
+std::vector<int> RelationshipGraph::getShortestPathLengths(const std::vector<std::pair<NodeID, NodeID>> &pairs,
+                                                           int maxDepth) const
+{
+    std::vector<int> lengths(pairs.size(), -1);
+    if (pairs.empty())
+        return lengths;
+
+    // The graph is only read while the pool runs, so the searches share it
+    ThreadPool &pool = ThreadPool::shared();
+    size_t grain = (pairs.size() + pool.size()) / (pool.size() + 1);
+
+    pool.parallelFor(pairs.size(), grain, [&](size_t, size_t begin, size_t end)
+                     {
+        for (size_t i = begin; i < end; i++)
+            lengths[i] = getShortestPathLength(pairs[i].first, pairs[i].second, maxDepth); });
+
+    return lengths;
+}
+
+DistanceEstimate RelationshipGraph::estimateShortestPathLength(NodeID from, NodeID to) const
+{
+    {
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        if (distanceOracle)
+            return distanceOracle->estimate(from, to);
+    }
+    return {getShortestPathLength(from, to), true};
+}
+
+void RelationshipGraph::buildDistanceOracle(size_t landmarks)
+{
+    oracleLandmarks = landmarks;
+    refreshSnapshots();
+    auto oracle = std::make_shared<DistanceOracle>(followsSnapshot(), landmarks);
+
+    std::lock_guard<std::mutex> guard(analyticsMutex);
+    distanceOracle = std::move(oracle);
+}
+
+bool RelationshipGraph::startDistanceOracleRefresh(size_t landmarks)
+{
+    if (oracleJob.valid())
+    {
+        if (oracleJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        oracleJob.get();
+    }
+
+    oracleLandmarks = landmarks;
+    refreshSnapshots();
+    std::shared_ptr<const CSRGraph> csr = followsSnapshot();
+    size_t builtAt = followsVersion;
+    oracleJob = std::async(std::launch::async, [this, csr, builtAt, landmarks]()
+                           {
+        auto oracle = std::make_shared<DistanceOracle>(csr, landmarks);
+
+        // Changes made during the build went to the old oracle only
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        if (followsVersion != builtAt)
+            oracle->changesMissed();
+        distanceOracle = std::move(oracle); });
+    return true;
+}
+
+MemoryUsage RelationshipGraph::memoryUsage() const
+{
+    MemoryUsage u = followsGraph.memoryUsage();
+    u += likesGraph.memoryUsage();
+    u += activeGraph.memoryUsage();
+    u += activeWindow.memoryUsage();
+    u += interests.memoryUsage();
+
+    // Results built on an older snapshot keep its node index alive; count
+    // each such index once
+    std::vector<std::shared_ptr<const CSRGraph::NodeIndex>> pinned;
+    {
+        std::lock_guard<std::mutex> guard(analyticsMutex);
+        if (distanceOracle)
+        {
+            u += distanceOracle->memoryUsage();
+            pinned.push_back(distanceOracle->nodeIndex());
+        }
+    }
+
+    std::shared_ptr<const PageRank> ranks = influenceScores();
+    if (ranks)
+    {
+        u += ranks->memoryUsage();
+        pinned.push_back(ranks->nodeIndex());
+    }
+    std::shared_ptr<const Communities> partition = communityPartition();
+    if (partition)
+    {
+        u += partition->memoryUsage();
+        pinned.push_back(partition->nodeIndex());
+    }
+    std::shared_ptr<const ReachSketches> sketches = reachSketches();
+    if (sketches)
+    {
+        u += sketches->memoryUsage();
+        pinned.push_back(sketches->nodeIndex());
+    }
+    std::shared_ptr<const ClusteringStats> stats = clusteringStats();
+    if (stats)
+        u += stats->coefficients.memoryUsage();
+
+    std::lock_guard<std::mutex> guard(snapshotMutex);
+    if (followsCSR)
+        u += followsCSR->memoryUsage();
+    if (likesCSR)
+        u += likesCSR->memoryUsage();
+
+    std::shared_ptr<const CSRGraph::NodeIndex> current = followsCSR ? followsCSR->nodeIndex() : nullptr;
+    for (size_t i = 0; i < pinned.size(); i++)
+    {
+        if (pinned[i] == current || std::find(pinned.begin(), pinned.begin() + i, pinned[i]) != pinned.begin() + i)
+            continue;
+        u += pinned[i]->memoryUsage();
+    }
+    return u;
+}
@@ -26,4 +26,9 @@ const char* StatusManager::getStatusString(ull userID) const
 void StatusManager::removeUser(ull userID)
 {
     statusMap.remove(userID);
-}
\ No newline at end of file
+}
+
+MemoryUsage StatusManager::memoryUsage() const
+{
+    return statusMap.memoryUsage();
+}
@@ -111,6 +111,16 @@ void User::display() const
     }
 }
 
+MemoryUsage User::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, uname);
+    addOwnedMemory(u, password);
+    addOwnedMemory(u, city);
+    return u;
+}
+
 // ============================================
 // UserManager Class Implementation
 // ============================================
@@ -303,7 +313,7 @@ User *UserManager::getUserByID(ull userID) const
     return userPtr ? *userPtr : nullptr;
 }
 
-User *UserManager::getUserByUsername(const std::string &uname) const
+User *UserManager::getUserByUsername(std::string_view uname) const
 {
     const ull *userIDPtr = usernameToID.get(uname);
     if (!userIDPtr)
@@ -314,7 +324,7 @@ User *UserManager::getUserByUsername(const std::string &uname) const
     return getUserByID(*userIDPtr);
 }
 
-ull UserManager::getUserIDByUsername(const std::string &uname) const
+ull UserManager::getUserIDByUsername(std::string_view uname) const
 {
     const ull *userIDPtr = usernameToID.get(uname);
     return userIDPtr ? *userIDPtr : 0;
@@ -456,4 +466,14 @@ bool UserManager::validatePassword(const std::string &pwd) const
 bool UserManager::validateCity(const std::string &city) const
 {
     return validator.isValidCity(city);
-}
\ No newline at end of file
+}
+
+MemoryUsage UserManager::memoryUsage() const
+{
+    MemoryUsage u = usersByID.memoryUsage();
+    u += usernameToID.memoryUsage();
+
+    for (auto it = usersByID.begin(); it != usersByID.end(); ++it)
+        u.addBytesOf((*it).value->memoryUsage());
+    return u;
+}
@@ -311,4 +311,15 @@ bool FriendRequestManager::loadFromFile()
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+MemoryUsage FriendRequestManager::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    u.slotsUsed = inbox.size() + outbox.size();
+    u.slotsTotal = inbox.capacity() + outbox.capacity();
+    addOwnedMemory(u, inbox);
+    addOwnedMemory(u, outbox);
+    return u;
+}
@@ -62,6 +62,16 @@ std::string Message::format() const
     return "[" + std::string(buff) + "] " + sender + " -> " + reciever + ": " + text;
 }
 
+MemoryUsage Message::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, sender);
+    addOwnedMemory(u, reciever);
+    addOwnedMemory(u, text);
+    return u;
+}
+
 // ============================================================================
 // Message System Implementation
 // ============================================================================
@@ -79,15 +89,22 @@ void MessageSystem::registerUser(User *user)
 void MessageSystem::sendMessage(const User &s, const User &r, const std::string &text)
 {
     Message msg(s.getUname(), r.getUname(), text);
-    std::string key = makeKey(s.getID(), r.getID());
 
-    chat[key].enqueue(msg);
+    char buf[KEY_LEN];
+    std::string_view key = makeKey(s.getID(), r.getID(), buf);
+
+    // Only the first message of a conversation materialises the key string
+    Queue<Message> *conversation = chat.get(key);
+    if (!conversation)
+        conversation = chat.try_emplace(std::string(key)).first;
+
+    conversation->enqueue(std::move(msg));
 }
 
 std::vector<Message> MessageSystem::getChatHistory(const User &u1, const User &u2) const
 {
-    std::string key = makeKey(u1.getID(), u2.getID());
-    auto it = chat.find(key);
+    char buf[KEY_LEN];
+    auto it = chat.find(makeKey(u1.getID(), u2.getID(), buf));
 
     if (it != chat.end())
     {
@@ -113,8 +130,8 @@ bool MessageSystem::markMessageRead(const User &u, unsigned long long msgID)
 
 Message MessageSystem::getLastestMessage(const User &u1, const User &u2) const
 {
-    std::string key = makeKey(u1.getID(), u2.getID());
-    auto it = chat.find(key);
+    char buf[KEY_LEN];
+    auto it = chat.find(makeKey(u1.getID(), u2.getID(), buf));
 
     if (it == chat.end() || (*it).value.isEmpty())
     {
@@ -143,10 +160,10 @@ bool MessageSystem::loadFromFile()
         {
             for (const auto &[key, msgArr] : j["chats"].items())
             {
+                Queue<Message> &conversation = chat[key];
                 for (const auto &msgJson : msgArr)
                 {
-                    Message m = Message::fromJSON(msgJson);
-                    chat[key].enqueue(m);
+                    conversation.enqueue(Message::fromJSON(msgJson));
                 }
             }
         }
@@ -317,4 +334,11 @@ void MessageSystem::clear()
 {
     chat.clear();
     users.clear();
+}
+
+MemoryUsage MessageSystem::memoryUsage() const
+{
+    MemoryUsage u = chat.memoryUsage();
+    u += users.memoryUsage();
+    return u;
 }
\ No newline at end of file
@@ -112,6 +112,7 @@ private:
                   << BOLD << "Quick Stats:" << RESET;
         std::cout << " Posts: " << stats.postCount;
         std::cout << " | Friends: " << stats.friendCount;
+        std::cout << " | Reach: " << (stats.twoHopReach < 0 ? "n/a" : "~" + std::to_string(stats.twoHopReach));
         std::cout << " | Unread: " << stats.unreadNotifications;
         std::cout << " | " << (stats.isOnline ? GREEN "●" : RED "○") << " " << (stats.isOnline ? "Online" : "Offline") << RESET << "\n\n";
 
@@ -394,6 +395,15 @@ private:
         {
         case 1: // View profile
             sysManager->displayUserProfile(targetUserID);
+            if (targetUserID != currentUserID)
+            {
+                DistanceEstimate hops = sysManager->getDegreesOfSeparation(currentUserID, targetUserID);
+                if (hops.distance > 0)
+                    printInfo(std::string("Degrees of separation: ") + (hops.exact ? "" : "≤ ") +
+                              std::to_string(hops.distance));
+                else
+                    printInfo("Not connected through the people you follow");
+            }
             break;
         case 2: // Follow
             if (sysManager->performFollowWithNotification(currentUserID, targetUserID))
@@ -917,6 +927,7 @@ public:
 
         while (true)
         {
+            sysManager->runPeriodicMaintenance();
             clearScreen();
 
             if (!isLoggedIn)
@@ -102,6 +102,14 @@ Notification Notification::fromJSON(const json &j)
     return n;
 }
 
+MemoryUsage Notification::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    addOwnedMemory(u, desc);
+    return u;
+}
+
 // Notification Manager class defination
 
 NotificationManager::NotificationManager(const std::string &fp) : cap(10), count(0), head(nullptr), filePath(fp)
@@ -131,7 +139,7 @@ NotificationManager::~NotificationManager()
     while (curr)
     {
         UnreadNode *next = curr->next;
-        delete curr;
+        unreadPool.destroy(curr);
         curr = next;
     }
 }
@@ -153,7 +161,7 @@ void NotificationManager::expand()
 
 void NotificationManager::addToUnread(Notification *n)
 {
-    UnreadNode *node = new UnreadNode;
+    UnreadNode *node = unreadPool.create();
     node->data = n;
     node->next = head;
     head = node;
@@ -175,7 +183,7 @@ void NotificationManager::removeFromUnread(Notification *n)
             else
                 prev->next = curr->next;
 
-            delete curr;
+            unreadPool.destroy(curr);
             return;
         }
         prev = curr;
@@ -284,7 +292,7 @@ void NotificationManager::markAllRead()
     while (curr)
     {
         UnreadNode *next = curr->next;
-        delete curr;
+        unreadPool.destroy(curr);
         curr = next;
     }
     head = nullptr;
@@ -385,7 +393,7 @@ bool NotificationManager::loadFromFile()
         while (curr)
         {
             UnreadNode *next = curr->next;
-            delete curr;
+            unreadPool.destroy(curr);
             curr = next;
         }
         head = nullptr;
@@ -416,4 +424,27 @@ bool NotificationManager::loadFromFile()
 }
 
 bool NotificationManager::empty() const { return count == 0; }
-unsigned long long NotificationManager::size() const { return count; }
\ No newline at end of file
+unsigned long long NotificationManager::size() const { return count; }
+
+MemoryUsage NotificationManager::memoryUsage() const
+{
+    MemoryUsage u;
+    u.metadataBytes = sizeof(*this);
+    u.payloadBytes = count * sizeof(Notification *);
+    u.overheadBytes = (cap - count) * sizeof(Notification *);
+    u.slotsUsed = count;
+    u.slotsTotal = cap;
+
+    for (unsigned long long i = 0; i < count; i++)
+        u.addBytesOf(list[i]->memoryUsage());
+
+    // The unread list is an index over the array; its pool slots are not ours
+    MemoryUsage unread;
+    size_t unreadCount = 0;
+    for (UnreadNode *curr = head; curr; curr = curr->next)
+        unreadCount++;
+    unread.metadataBytes = unreadCount * sizeof(UnreadNode);
+    unreadPool.accountMemory(unread, unreadCount);
+    u.addBytesOf(unread);
+    return u;
+}
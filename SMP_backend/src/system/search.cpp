@@ -549,4 +549,13 @@ std::vector<void *> SearchEngine::search(const std::string &query, SearchType ty
     }
 
     return results;
-}
\ No newline at end of file
+}
+
+MemoryUsage SearchEngine::memoryUsage() const
+{
+    MemoryUsage u = userMap.memoryUsage();
+    u += systemTrie.memoryUsage();
+    addOwnedMemory(u, users);
+    addOwnedMemory(u, systemItems);
+    return u;
+}
@@ -1,7 +1,16 @@
 #include "system/SystemManager.hpp"
+#include <cmath>
 #include <iostream>
+#include <iomanip>
+#include <cstdio>
 #include <ctime>
 
+// Seconds between refreshes of the graph analytics in runPeriodicMaintenance
+static const long long ANALYTICS_REFRESH_INTERVAL = 60;
+static const long long CLUSTERING_REFRESH_INTERVAL = 24 * 60 * 60;
+// Deepest search for a separation the distance oracle has no route for
+static const int SEPARATION_SEARCH_DEPTH = 6;
+
 // ============================================================================
 // CONSTRUCTOR & DESTRUCTOR
 // ============================================================================
@@ -20,6 +29,8 @@ SystemManager::SystemManager()
     notifMgr = new NotificationManager("data/notifications.json");
     msgSys = new MessageSystem("data/messages.json");
     reqMgr = new FriendRequestManager("data/requests.json");
+    lastAnalyticsRefresh = 0;
+    lastClusteringRefresh = 0;
 }
 
 SystemManager::~SystemManager()
@@ -61,13 +72,14 @@ void SystemManager::cascadeUserDeletion(ull userID)
             // searchEng handles this internally when post is removed
 
             // Remove like edges from graph
-            const Set<NodeID> *likers = relGraph->getPostLikes(postID);
+            const AdjacencySet *likers = relGraph->getPostLikes(postID);
             if (likers)
             {
-                const auto &data = likers->data();
-                for (size_t i = 0; i < likers->size(); i++)
+                // Copy: each unlike erases from the set being read
+                std::vector<NodeID> likerIDs = likers->toVector();
+                for (NodeID liker : likerIDs)
                 {
-                    relGraph->unlikePost(data[i], postID);
+                    relGraph->unlikePost(liker, postID);
                 }
             }
 
@@ -370,6 +382,9 @@ bool SystemManager::performCompleteLogout(ull userID)
     // Step 3: Clear active connections (optional)
     // This can be done lazily via expireOldActivities()
 
+    // Step 4: Pack the now-idle user's follow lists
+    relGraph->compressUser(userID);
+
     std::cout << "Logout successful for user: " << username << "\n";
     return true;
 }
@@ -433,6 +448,7 @@ bool SystemManager::setUserOffline(ull userID)
     }
 
     statusMgr->setOffline(userID);
+    relGraph->compressUser(userID);
     return true;
 }
 
@@ -515,13 +531,14 @@ bool SystemManager::deletePost(ull postID)
     }
 
     // Step 2: Remove all like edges from graph
-    const Set<NodeID> *likers = relGraph->getPostLikes(postID);
+    const AdjacencySet *likers = relGraph->getPostLikes(postID);
     if (likers)
     {
-        const auto &data = likers->data();
-        for (size_t i = 0; i < likers->size(); i++)
+        // Copy: each unlike erases from the set being read
+        std::vector<NodeID> likerIDs = likers->toVector();
+        for (NodeID liker : likerIDs)
         {
-            relGraph->unlikePost(data[i], postID);
+            relGraph->unlikePost(liker, postID);
         }
     }
 
@@ -695,15 +712,14 @@ bool SystemManager::isFollowing(ull followerID, ull followeeID) const
 
 std::vector<ull> SystemManager::getFollowers(ull userID) const
 {
-    const Set<NodeID> *followers = relGraph->getFollowers(userID);
+    const AdjacencySet *followers = relGraph->getFollowers(userID);
     std::vector<ull> result;
 
     if (followers)
     {
-        const auto &data = followers->data();
-        for (size_t i = 0; i < followers->size(); i++)
+        for (NodeID id : *followers)
         {
-            result.push_back(data[i]);
+            result.push_back(id);
         }
     }
 
@@ -712,15 +728,14 @@ std::vector<ull> SystemManager::getFollowers(ull userID) const
 
 std::vector<ull> SystemManager::getFollowing(ull userID) const
 {
-    const Set<NodeID> *following = relGraph->getFollowing(userID);
+    const AdjacencySet *following = relGraph->getFollowing(userID);
     std::vector<ull> result;
 
     if (following)
     {
-        const auto &data = following->data();
-        for (size_t i = 0; i < following->size(); i++)
+        for (NodeID id : *following)
         {
-            result.push_back(data[i]);
+            result.push_back(id);
         }
     }
 
@@ -758,6 +773,29 @@ bool SystemManager::areUsersFriends(ull userID1, ull userID2) const
            relGraph->isFollowing(userID2, userID1);
 }
 
+DistanceEstimate SystemManager::getDegreesOfSeparation(ull viewerID, ull profileID, bool requireExact) const
+{
+    DistanceEstimate estimate = relGraph->estimateShortestPathLength(viewerID, profileID);
+    if (estimate.exact)
+        return estimate;
+
+    // No landmark on any path: search, but only as far as a separation is worth showing
+    if (estimate.distance < 0)
+    {
+        int hops = relGraph->getShortestPathLength(viewerID, profileID, SEPARATION_SEARCH_DEPTH);
+        return {hops, hops >= 0};
+    }
+
+    // An upper bound, which also caps the search
+    if (requireExact)
+    {
+        int hops = relGraph->getShortestPathLength(viewerID, profileID, estimate.distance);
+        if (hops >= 0)
+            return {hops, true};
+    }
+    return estimate;
+}
+
 // ============================================================================
 // FRIEND REQUEST OPERATIONS
 // ============================================================================
@@ -1255,13 +1293,12 @@ std::vector<ull> SystemManager::getActiveConnections(ull userID) const
 {
     std::vector<ull> activeUsers;
 
-    const Set<NodeID> *activeWith = relGraph->getActiveWith(userID);
+    const AdjacencySet *activeWith = relGraph->getActiveWith(userID);
     if (activeWith)
     {
-        const auto &data = activeWith->data();
-        for (size_t i = 0; i < activeWith->size(); i++)
+        for (NodeID id : *activeWith)
         {
-            activeUsers.push_back(data[i]);
+            activeUsers.push_back(id);
         }
     }
 
@@ -1273,6 +1310,29 @@ void SystemManager::clearAllActivities()
     relGraph->clearActive();
 }
 
+void SystemManager::runPeriodicMaintenance()
+{
+    expireOldActivities();
+
+    long long now = static_cast<long long>(std::time(nullptr));
+
+    // Nightly job: the per-user and global clustering coefficients
+    if (lastClusteringRefresh == 0 || now - lastClusteringRefresh >= CLUSTERING_REFRESH_INTERVAL)
+    {
+        lastClusteringRefresh = now;
+        relGraph->startClusteringRefresh();
+    }
+
+    if (lastAnalyticsRefresh != 0 && now - lastAnalyticsRefresh < ANALYTICS_REFRESH_INTERVAL)
+        return;
+    lastAnalyticsRefresh = now;
+
+    // Recompute stale influence scores, communities, reach sketches and the
+    // distance oracle in the background (each skipped while its last run is
+    // still going)
+    relGraph->startStaleRefreshes();
+}
+
 // ============================================================================
 // ANALYTICS & STATISTICS
 // ============================================================================
@@ -1289,6 +1349,7 @@ SystemManager::UserStats SystemManager::getUserStats(ull userID) const
     stats.totalLikes = 0;
     stats.unreadNotifications = 0;
     stats.pendingRequests = 0;
+    stats.twoHopReach = -1;
     stats.isOnline = false;
 
     // Check if user exists
@@ -1324,6 +1385,13 @@ SystemManager::UserStats SystemManager::getUserStats(ull userID) const
     std::vector<FriendRequest> pendingIncoming = getPendingIncomingRequests(userID);
     stats.pendingRequests = pendingIncoming.size();
 
+    // Users within two follow hops, only once the sketches cover the user:
+    // the exact fallback is a traversal, too costly for every dashboard render
+    std::shared_ptr<const ReachSketches> sketches = relGraph->reachSketches();
+    double reach = sketches ? sketches->estimate(userID, 2) : -1.0;
+    if (reach >= 0.0)
+        stats.twoHopReach = std::llround(reach);
+
     // Check online status
     stats.isOnline = isUserOnline(userID);
 
@@ -1452,6 +1520,37 @@ void SystemManager::displayAllPosts() const
     postMgr->displayAll();
 }
 
+// Bytes as B/KB/MB/GB with one decimal
+static std::string formatBytes(size_t bytes)
+{
+    const char *units[] = {"B", "KB", "MB", "GB"};
+    double value = (double)bytes;
+    int unit = 0;
+    while (value >= 1024 && unit < 3)
+    {
+        value /= 1024;
+        unit++;
+    }
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), unit ? "%.1f %s" : "%.0f %s", value, units[unit]);
+    return buf;
+}
+
+static void printMemoryRow(const char *name, const MemoryUsage &m)
+{
+    char load[16];
+    std::snprintf(load, sizeof(load), "%.2f", m.loadFactor());
+
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(10) << formatBytes(m.total())
+              << std::setw(10) << formatBytes(m.payloadBytes)
+              << std::setw(10) << formatBytes(m.metadataBytes)
+              << std::setw(10) << formatBytes(m.overheadBytes)
+              << std::setw(6) << load
+              << std::setw(7) << m.longestProbe << "\n";
+}
+
 void SystemManager::displaySystemStatus() const
 {
     std::cout << "\n========================================\n";
@@ -1481,6 +1580,37 @@ void SystemManager::displaySystemStatus() const
     std::cout << "  Total Notifications: " << notifMgr->size() << "\n";
     std::cout << "  Unread Notifications: " << notifMgr->countUnread() << "\n";
 
+    // Feed Manager and Recommendation Engine own no containers
+    struct ModuleMemory
+    {
+        const char *name;
+        MemoryUsage usage;
+    };
+    ModuleMemory modules[] = {
+        {"User Manager", userMgr->memoryUsage()},
+        {"Relationship Graph", relGraph->memoryUsage()},
+        {"Status Manager", statusMgr->memoryUsage()},
+        {"Follower List", followerList->memoryUsage()},
+        {"Post Manager", postMgr->memoryUsage()},
+        {"Search Engine", searchEng->memoryUsage()},
+        {"Message System", msgSys->memoryUsage()},
+        {"Notification Manager", notifMgr->memoryUsage()},
+        {"Friend Request Manager", reqMgr->memoryUsage()}};
+
+    std::cout << "\nMemory Usage:\n";
+    std::cout << "  " << std::left << std::setw(24) << "Module" << std::right
+              << std::setw(10) << "Total" << std::setw(10) << "Payload"
+              << std::setw(10) << "Metadata" << std::setw(10) << "Overhead"
+              << std::setw(6) << "Load" << std::setw(7) << "Probe" << "\n";
+
+    MemoryUsage total;
+    for (const ModuleMemory &m : modules)
+    {
+        printMemoryRow(m.name, m.usage);
+        total += m.usage;
+    }
+    printMemoryRow("All Modules", total);
+
     std::cout << "\nSystem Health: OPERATIONAL\n";
     std::cout << "========================================\n\n";
 }
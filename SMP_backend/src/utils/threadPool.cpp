@@ -0,0 +1,56 @@
+#include "utils/threadPool.hpp"
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &t : workers)
+        t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.enqueue(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this]
+                      { return stopping || !tasks.isEmpty(); });
+
+            // Drain what is queued before exiting
+            if (tasks.isEmpty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.dequeue();
+        }
+        task();
+    }
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
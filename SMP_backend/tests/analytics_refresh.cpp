@@ -0,0 +1,105 @@
+// Check: RelationshipGraph::startStaleRefreshes fills in the graph analytics
+//
+// Build from SMP_backend/:
+//   g++ -std=c++17 -O2 -pthread -I include tests/analytics_refresh.cpp src/core/relationGraph.cpp
+//       src/core/pageRank.cpp src/core/communities.cpp src/core/reachSketches.cpp
+//       src/core/distanceOracle.cpp src/core/interestIndex.cpp src/utils/threadPool.cpp
+//       -o build/check_analytics
+//
+// Exits non-zero and names the failed check if any result is missing or stale.
+
+#include "core/relationGraph.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    std::cout << (ok ? "ok    " : "FAIL  ") << what << "\n";
+    if (!ok)
+        failures++;
+}
+
+// Ticks startStaleRefreshes, as the main loop does, until ready() holds or a
+// few seconds pass. A tick is skipped while an earlier run is still going.
+template <typename Ready>
+static bool refreshUntil(RelationshipGraph &graph, Ready ready)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (graph.startStaleRefreshes(), !ready())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+int main()
+{
+    RelationshipGraph graph(64);
+    for (NodeID user = 1; user <= 6; user++)
+        graph.registerUser(user);
+
+    // Everyone follows 1; 2..4 follow each other in a ring
+    for (NodeID user = 2; user <= 6; user++)
+        graph.follow(user, 1);
+    graph.follow(2, 3);
+    graph.follow(3, 4);
+    graph.follow(4, 2);
+
+    check(!graph.influenceScores(), "no influence scores before the first refresh");
+    check(!graph.communityPartition(), "no communities before the first refresh");
+    check(!graph.reachSketches(), "no reach sketches before the first refresh");
+
+    check(refreshUntil(graph, [&]
+                       { return graph.influenceScores() != nullptr; }),
+          "influence scores filled in by startStaleRefreshes");
+    check(graph.getInfluenceScore(1) > graph.getInfluenceScore(6), "the most followed user ranks highest");
+    check(refreshUntil(graph, [&]
+                       { return graph.communityPartition() != nullptr; }),
+          "communities filled in by startStaleRefreshes");
+    check(graph.getCommunity(2) != Communities::NONE && graph.getCommunity(2) == graph.getCommunity(3),
+          "users in the follow ring share a community");
+    check(refreshUntil(graph, [&]
+                       { return graph.reachSketches() != nullptr; }),
+          "reach sketches filled in by startStaleRefreshes");
+    check(graph.reachSketches()->estimate(2, 1) > 0.0, "reach estimated from the sketches");
+
+    // A follow makes the scores stale; the next pass replaces them
+    std::shared_ptr<const PageRank> before = graph.influenceScores();
+    graph.registerUser(7);
+    graph.follow(7, 6);
+    check(refreshUntil(graph, [&]
+                       { return graph.influenceScores() != before; }),
+          "stale influence scores replaced after a follow");
+    check(graph.getInfluenceScore(7) > 0.0, "new user scored after the refresh");
+    check(refreshUntil(graph, [&]
+                       { return graph.getCommunity(7) != Communities::NONE; }),
+          "new user placed in a community after a follow");
+    check(refreshUntil(graph, [&]
+                       { return graph.reachSketches()->estimate(7, 1) >= 0.0; }),
+          "new user sketched after a follow");
+
+    // Unchanged graph: nothing to redo
+    before = graph.influenceScores();
+    std::shared_ptr<const Communities> partition = graph.communityPartition();
+    std::shared_ptr<const ReachSketches> sketches = graph.reachSketches();
+    graph.startStaleRefreshes();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    check(graph.influenceScores() == before, "current influence scores left alone");
+    check(graph.communityPartition() == partition, "current communities left alone");
+    check(graph.reachSketches() == sketches, "current reach sketches left alone");
+
+    // Clustering has its own (daily) schedule, started directly
+    check(!graph.clusteringStats(), "no clustering stats before the first refresh");
+    check(graph.startClusteringRefresh(), "clustering refresh started");
+    check(refreshUntil(graph, [&]
+                       { return graph.clusteringStats() != nullptr; }),
+          "clustering stats filled in by startClusteringRefresh");
+    check(graph.getCachedClusteringCoefficient(2) == 1.0, "2's followees 1 and 3 are linked");
+
+    return failures == 0 ? 0 : 1;
+}